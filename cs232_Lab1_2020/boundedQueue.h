@@ -0,0 +1,65 @@
+/**********************************************************************
+ * File name: boundedQueue.h
+ * -----------------------
+ * This file defines the BoundedQueue class, a first-in first-out
+ * queue with a fixed capacity that can be shared by threads.
+ *
+ * push() waits while the queue is full and pop() waits while it is
+ * empty, so a fast producer can never run more than capacity items
+ * ahead of its consumer. Once the producer calls close(), pop() still
+ * returns the items left in the queue and then returns false. A queue
+ * is also closed when a stage of a pipeline fails; push() then drops
+ * its item instead of waiting for a consumer that may be gone.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <deque>               // deque<T> items
+#include <mutex>               // mutex, unique_lock
+#include <condition_variable>  // condition_variable
+using namespace std;
+
+
+/*
+ * Type: BoundedQueue
+ * ------------------
+ * This type represents a thread-safe queue of at most capacity items.
+ * T is the item class.
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+    deque<T> items;                  // items in arrival order
+    size_t capacity;                 // max number of items
+    bool closed;                     // no more items will be pushed
+    mutex lock;                      // guards all members
+    condition_variable notFull;      // signaled when an item is popped
+    condition_variable notEmpty;     // signaled when an item is pushed or the queue is closed
+
+public:
+    /* Constructor */
+    explicit BoundedQueue(size_t capacity);
+
+    /* Add an item, waiting while the queue is full; false, without adding it, once closed */
+    bool push(const T& item);
+
+    /* Move an item in, waiting while the queue is full; false, leaving it with the caller, once closed */
+    bool push(T&& item);
+
+    /* Remove the oldest item, waiting while the queue is empty; false once closed and drained */
+    bool pop(T& item);
+
+    /* Tell the consumers that no more items will be pushed, and wake waiting producers */
+    void close();
+
+}; /* end of BoundedQueue class */
+
+#include "boundedQueue.t"
+
+#endif //BOUNDEDQUEUE_H
@@ -0,0 +1,109 @@
+/**********************************************************************
+ * File name: boundedQueue.t
+ * -----------------------
+ * This file implements all templated functions of the BoundedQueue class.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef BOUNDEDQUEUE_T
+#define BOUNDEDQUEUE_T
+
+#include <utility>     // move
+
+/*******************************************************************************************
+ * Constructor: BoundedQueue
+ * ------------------
+ * Purpose: To initialize an empty, open queue.
+ *
+ * Input Parameters:
+ *          capacity: max number of items, at least 1.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+    : capacity(capacity > 0 ? capacity : 1), closed(false)
+{
+}
+
+
+/*******************************************************************************************
+ * Function Name: push
+ * ------------------
+ * Purpose: To add an item at the back of the queue, waiting for room if it is full. An
+ *          item is only moved while the queue is locked; one that must be copied is copied
+ *          before, so large items such as chunks of text do not hold up the other threads.
+ *
+ * Input Parameters:
+ *          item: the item to add, moved from only if it is added.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: false if the queue is closed; the item is not added.
+ *******************************************************************************************/
+template <typename T>
+bool BoundedQueue<T>::push(const T& item)
+{
+    return push(T(item));
+}
+
+template <typename T>
+bool BoundedQueue<T>::push(T&& item)
+{
+    unique_lock<mutex> guard(lock);
+    notFull.wait(guard, [this] { return items.size() < capacity || closed; });
+    if (closed)
+        return false;
+    items.push_back(std::move(item));
+    notEmpty.notify_one();
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: pop
+ * ------------------
+ * Purpose: To remove the item at the front of the queue, waiting for one if it is empty.
+ *
+ * Input Parameters: none.
+ * Output parameters:
+ *          item: the removed item.
+ * Return Value:
+ *          bool: false if the queue is closed and empty.
+ *******************************************************************************************/
+template <typename T>
+bool BoundedQueue<T>::pop(T& item)
+{
+    unique_lock<mutex> guard(lock);
+    notEmpty.wait(guard, [this] { return !items.empty() || closed; });
+    if (items.empty())
+        return false;
+    item = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: close
+ * ------------------
+ * Purpose: To wake up every waiting consumer once no more items will be pushed, and every
+ *          producer waiting for room.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void BoundedQueue<T>::close()
+{
+    lock_guard<mutex> guard(lock);
+    closed = true;
+    notEmpty.notify_all();
+    notFull.notify_all();
+}
+
+#endif //BOUNDEDQUEUE_T
@@ -6,332 +6,543 @@
 
 #include <iostream>
 #include <fstream>
-#include <cmath>
 #include <string>
+#include <cstdlib>
+#include <thread>
+#include "extSort.h"
+#include "logRecord.h"
+#include "extSelect.h"
+#include "extVerify.h"
 
 using namespace std;
 
-template <typename T>
-void msSort(T* arrayptr, const int& arraySize); // algorithm for sorting blocks
-const size_t MAX_MEM_SIZE = 20;  // max memory size
-const size_t TOTAL_SIZE = 120;   // total data size
+const size_t DEFAULT_MEM_BUDGET = 20 * sizeof(int);  // default memory budget in bytes (20 ints)
+const size_t BATCH_MEM_BUDGET = 64 << 20;            // default memory budget in bytes of a batch sort
 
 // Function Prototypes:
-int* readBlockFromFile(ifstream& in);
-void storeToFile(int* arrPtr, ofstream& out);
-void setupFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2);
-void closeFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2);
-void mergeRuns(int& record1, int& record2, size_t runSize, ifstream& inFile1, ifstream& inFile2, ofstream& outFile);
-void mergeFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile);
-void splitFiles(int& blockNum, ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2);
-void mergeFileRuns(int times, ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2);
-void askUserForInputFile(string prompt, ifstream& inFile);
+bool parseKeyBound(const string& text, bool& bounded, long long& key);
+bool parseNumber(const string& text, unsigned long long& value);
+bool parsePositional(int argc, char* argv[], SortOptions& options, string& format, string& reduce,
+                     Selection<long long>& range);
+bool parseFlags(int argc, char* argv[], SortOptions& options, string& inName, string& outName, string& format,
+                string& reduce, Selection<long long>& range, bool& verbose, string& statsName, bool& verify);
+void printUsage(ostream& out, const char* program);
+string setupFiles(ifstream& inFile);
+string askUserForInputFile(string prompt, ifstream& inFile);
+template <typename Record, typename KeyOf>
+SortResult sortRecords(const string& inName, const string& outName, const SortOptions& options, const string& reduce,
+                       bool countComparisons);
+template <typename Record, typename KeyOf>
+SortResult selectRecords(const string& inName, const string& outName, const SortOptions& options,
+                         const Selection<long long>& range, bool countComparisons);
+void writeStats(const string& statsName, const string& inName, const string& outName, const SortOptions& options,
+                const SortResult& result);
+template <typename Record, typename KeyOf>
+bool verifyRecords(const string& inName, const string& outName, const string& reduce,
+                   const Selection<long long>& range, bool verbose);
+string jsonString(const string& text);
 
 // Main Function:
-int main() {
-    ifstream inFile1, inFile2;
-    ofstream outFile1, outFile2;
-    int blockNum = TOTAL_SIZE / MAX_MEM_SIZE;  // block number specified by memory size
-
-    // Open source files to read data:
-    setupFiles(inFile1, inFile2, outFile1, outFile2);
-
-    // Split files into blocks:
-    splitFiles(blockNum, inFile1, inFile2, outFile1, outFile2);
-
-    // Merge runs from outFile1 and outFile2  to  inFile1 and inFile2:
-    inFile1.open("outFile1.txt");      // open necessary files in correct read/write mode
-    inFile2.open("outFile2.txt");
-    outFile1.open("inFile1.txt");
-    outFile2.open("inFile2.txt");
-    mergeFileRuns(0, inFile1, inFile2, outFile1, outFile2);     // Merge runs
-    closeFiles(inFile1, inFile2, outFile1, outFile2);           // close all files
+int main(int argc, char* argv[]) {
+    ifstream inFile;
+
+    // Arguments that start with "-" are the flags of a batch sort, which reads a file or
+    // standard input and writes a file or standard output without asking anything.
+    // Otherwise they are the positional arguments of the interactive sorter, which asks
+    // for the input file and writes Sorted.txt:
+    SortOptions options = { DEFAULT_MEM_BUDGET, REPLACEMENT_SELECTION, thread::hardware_concurrency(), 0, false, true,
+                            "", false, 0 };
+    string inName, outName = "Sorted.txt";
+    string format = "int";
+    string reduce = "all";
+    Selection<long long> range = { 0, false, 0, false, 0 };
+    bool batch = argc > 1 && argv[1][0] == '-';
+    bool verbose = !batch;
+    string statsName;                    // where to write the statistics of a batch sort, "" for nowhere
+    bool verify = false;                 // whether to check the output of a batch sort against its input
+    bool badArgs;
+    if (batch)
+    {
+        if (string(argv[1]) == "-h" || string(argv[1]) == "--help") {
+            printUsage(cout, argv[0]);
+            return 0;
+        }
+        options.memBudget = BATCH_MEM_BUDGET;
+        inName = outName = STANDARD_STREAM;
+        badArgs = !parseFlags(argc, argv, options, inName, outName, format, reduce, range, verbose, statsName, verify);
+    }
+    else
+        badArgs = !parsePositional(argc, argv, options, format, reduce, range);
+    bool selecting = range.limit > 0 || range.hasLow || range.hasHigh;
+    badArgs = badArgs || (selecting && reduce != "all");
+    badArgs = badArgs || (verify && (inName == STANDARD_STREAM || outName == STANDARD_STREAM || reduce == "count"));
+    if (badArgs) {
+        printUsage(batch ? cerr : cout, argv[0]);
+        return 1;
+    }
+    if (options.threadNum == 0)
+        options.threadNum = 1;
 
-    // Now merge runs from inFile1 and inFile2  to  outFile1 and outFile2:
-    inFile1.open("inFile1.txt");       // open necessary files in correct read/write mode in reverse
-    inFile2.open("inFile2.txt");
-    outFile1.open("outFile1.txt");
-    outFile2.open("outFIle2.txt");
-    mergeFileRuns(1, inFile1, inFile2, outFile1, outFile2);     // Merge runs
-    closeFiles(inFile1, inFile2, outFile1, outFile2);           // close all files
+    // Open source file to read data:
+    if (batch)
+        ios::sync_with_stdio(false);      // standard input and output are read and written a buffer at a time
+    else
+    {
+        inName = setupFiles(inFile);
+        inFile.close();
+    }
 
-    // Finally, merge from outFile1 and outFile2  to  Sorted.txt:
-    inFile1.open("outFile1.txt");      // open necessary files in correct read/write mode
-    inFile2.open("outFile2.txt");
-    outFile1.open("Sorted.txt");
-    mergeFiles(inFile1, inFile2, outFile1);                     // Merge runs
-    closeFiles(inFile1, inFile2, outFile1, outFile2);           // close all files
+    // Sort the source file in memory if it fits, else split it into sorted runs
+    // and merge them until everything is in the output file:
+    SortResult result;
+    bool counting = !statsName.empty();
+    try {
+        if (selecting && format == "log")
+            result = selectRecords<LogRecord, LogTimestamp>(inName, outName, options, range, counting);
+        else if (selecting)
+            result = selectRecords<int, IdentityKey>(inName, outName, options, range, counting);
+        else if (format == "log")
+            result = sortRecords<LogRecord, LogTimestamp>(inName, outName, options, reduce, counting);
+        else
+            result = sortRecords<int, IdentityKey>(inName, outName, options, reduce, counting);
+        if (!statsName.empty())
+            writeStats(statsName, inName, outName, options, result);
+    }
+    catch (const runtime_error& error) {
+        (batch ? cerr : cout) << "Unable to sort \"" << inName << "\": " << error.what() << endl;
+        return 1;
+    }
 
-    cout << "Final result is in \"Sorted.txt\"." << endl;
+    // Read the input and the output once more to check that the output is in order and
+    // holds the records of the input:
+    try {
+        bool good = true;
+        if (verify && format == "log")
+            good = verifyRecords<LogRecord, LogTimestamp>(inName, outName, reduce, range, verbose);
+        else if (verify)
+            good = verifyRecords<int, IdentityKey>(inName, outName, reduce, range, verbose);
+        if (!good)
+            return 1;
+    }
+    catch (const runtime_error& error) {
+        cerr << "Unable to verify \"" << outName << "\": " << error.what() << endl;
+        return 1;
+    }
+    if (!verbose)
+        return 0;
+
+    // A batch sort reports on standard error, which is not the output:
+    ostream& report = batch ? cerr : cout;
+    const char* done = selecting ? "Selected from " : "Sorted ";
+    if (result.inMemory)
+        report << done << result.recordNum << " records in memory." << endl;
+    else if (options.tapeNum > 0 && !selecting)
+        report << done << result.recordNum << " records in " << result.runNum << " run(s) with "
+               << result.passNum << " polyphase merge phase(s) on " << options.tapeNum << " tapes." << endl;
+    else
+        report << done << result.recordNum << " records in " << result.runNum << " run(s) with "
+               << result.passNum << " merge pass(es) of up to " << result.fanIn << " runs." << endl;
+    if (batch)
+        return 0;
+    cout << "Final result is in \"" << outName << "\"." << endl;
     cout << "Have a good day!" << endl;
     return 0;
 }  /* end of main */
 
 
-/// Opens a text file whose name is entered by the user.
-/// If the file does not exist, the user is given additional chances to enter a valid file.
-/// @param prompt used to tell the user what kind of file is required.
-/// @param inFile input file stream
-void askUserForInputFile(string prompt, ifstream& inFile)
+/// Read the positional arguments of the interactive sorter. The memory budget in bytes may be
+/// given as the first argument, e.g. "64M", the run generation method as the second one,
+/// the # of sort threads as the third one, the # of tape files for a polyphase merge (0 for
+/// a k-way merge) as the fourth one, the record format as the fifth one: "int" for integers,
+/// "log" for log lines by timestamp, the run coding as the sixth one: "plain", or "delta" to
+/// delta code runs of integers, what to keep of records with equal keys as the seventh one:
+/// "all", "unique" or "count", and to select only some records, the # of smallest records to
+/// keep (0 for all) as the eighth one and the smallest and largest keys to keep ("-" for no
+/// bound) as the ninth and tenth ones, the directory of the temporary files ("-" for the
+/// current one) as the eleventh one, and "resume" to finish an interrupted sort into
+/// Sorted.txt (or "fresh") as the twelfth one.
+/// @param argc # of arguments
+/// @param argv the arguments
+/// @param options set to the memory budget, run method, # of threads, # of tapes, run coding,
+///                temporary directory and resume
+/// @param format set to "int" or "log"
+/// @param reduce set to "all", "unique" or "count"
+/// @param range set to the # of smallest records to keep and the key range
+/// @return false if an argument is not valid
+bool parsePositional(int argc, char* argv[], SortOptions& options, string& format, string& reduce,
+                     Selection<long long>& range)
 {
-    while (true)
+    bool badArgs = false;
+    if (argc > 1)
+        badArgs = badArgs || (options.memBudget = parseByteSize(argv[1])) == 0;
+    if (argc > 2)
     {
-        string file;
-        cout << prompt;
-        getline(cin, file);
-        inFile.open(file); // trying to open file path
-        if (!inFile.fail()) break;
-        cout << "Unable to locate file \"" << file << "\""<< endl;
-        inFile.clear(); // recover from input file failure
+        string method = argv[2];
+        options.runMethod = (method == "block") ? BLOCK_SORT : REPLACEMENT_SELECTION;
+        badArgs = badArgs || (method != "block" && method != "replace");
     }
-}
-
-/// Open files and check if it is correctly opened.
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile1 first output file
-/// @param outFile2 second output file
-void setupFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2)
-{
-    askUserForInputFile("Input file(data.txt)? ", inFile1);
-    inFile2.open("inFile2.txt");        // open all the necessary files for sorting
-    outFile1.open("outFile1.txt");
-    outFile2.open("outFile2.txt");
-    cout << " *** File loaded successfully ***" << endl;
-}
-
-/// Close all the opened file.
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile1 first output file
-/// @param outFile2 second output file
-void closeFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2)
-{
-    inFile1.close();
-    inFile2.close();
-    outFile1.close();
-    outFile2.close();
-}
-
-/// Merge all runs from two input files into two output files
-/// @param times the # of runs in input files
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile1 first output file
-/// @param outFile2 second output file
-void mergeFileRuns(int times, ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2)
-{
-    int record1, record2;  // data in file1 and file2
-    inFile1 >> record1;    //  read data1 from outFile1
-    inFile2 >> record2;    //  read data2 from outFile2
-    int whoseTurn = 0;     //  needed for alternately place in the two files
-    size_t runSize = MAX_MEM_SIZE * pow(2.0, times); // the size of each run inside a file
-
-    while (!inFile1.eof() && !inFile2.eof())    // while neither the end inFile 1 nor inFile 2
+    if (argc > 3)
+        badArgs = badArgs || (options.threadNum = strtoul(argv[3], nullptr, 10)) == 0;
+    if (argc > 4)
+        badArgs = badArgs || ((options.tapeNum = strtoul(argv[4], nullptr, 10)) != 0 && options.tapeNum < 3);
+    if (argc > 5)
+        badArgs = badArgs || ((format = argv[5]) != "int" && format != "log");
+    if (argc > 6)
     {
-        if (whoseTurn % 2 == 0)  // alternately place run in the outFile1 and outFile2
-            mergeRuns(record1, record2, runSize, inFile1, inFile2, outFile1); // merge runs into output file 1
-        else
-            mergeRuns(record1, record2, runSize, inFile1, inFile2, outFile2); // merge runs into output file 2
-        whoseTurn++;
-    }
-
-    if (inFile1.eof()) {                        // Now reach the end of inFile 1 or inFile 2, copy the rest if necessarily
-        while (!inFile2.eof())
-        {
-            outFile1 << record2 << "  ";
-            inFile2 >> record2;
-        }
+        string coding = argv[6];
+        options.deltaRuns = (coding == "delta");
+        badArgs = badArgs || (coding != "delta" && coding != "plain");
     }
-    else if (inFile2.eof())
+    if (argc > 7)
+        badArgs = badArgs || ((reduce = argv[7]) != "all" && reduce != "unique" && reduce != "count");
+    if (argc > 8)
+        range.limit = strtoull(argv[8], nullptr, 10);
+    if (argc > 9)
+        badArgs = badArgs || !parseKeyBound(argv[9], range.hasLow, range.low);
+    if (argc > 10)
+        badArgs = badArgs || !parseKeyBound(argv[10], range.hasHigh, range.high);
+    if (argc > 11 && string(argv[11]) != "-")
+        options.tempDir = argv[11];
+    if (argc > 12)
     {
-        while (!inFile1.eof())
-        {
-            outFile2 << record1 << "  ";
-            inFile1 >> record1;
-        }
+        string start = argv[12];
+        options.resume = (start == "resume");
+        badArgs = badArgs || (start != "resume" && start != "fresh");
     }
+    return !badArgs && argc <= 13;
 }
 
-/// Merge two runs in terms of run size in two sub files and produce output into a output file.
-/// @param record1 data in input file1
-/// @param record2 data in input file2
-/// @param runSize run number in a file
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile output file stream
-void mergeRuns(int& record1, int& record2, size_t runSize,
-               ifstream& inFile1, ifstream& inFile2, ofstream& outFile)
+/// Read the flags of a batch sort, e.g. "-i data.txt -o - -m 64M -T /tmp -k 64 -t 8 -f log".
+/// A flag that takes a value is followed by it as the next argument.
+/// @param argc # of arguments
+/// @param argv the arguments
+/// @param options set to the memory budget, run method, # of threads, # of tapes, run coding,
+///                temporary directory, fan-in and resume
+/// @param inName set to the input file, "-" for standard input
+/// @param outName set to the output file, "-" for standard output
+/// @param format set to "int" or "log"
+/// @param reduce set to "all", "unique" or "count"
+/// @param range set to the # of smallest records to keep and the key range
+/// @param verbose set to whether to report what the sort did on standard error
+/// @param statsName set to the file to write the statistics to, "-" for standard error
+/// @param verify set to whether to check the output against the input after the sort
+/// @return false if a flag is unknown, or a value is missing or not valid
+bool parseFlags(int argc, char* argv[], SortOptions& options, string& inName, string& outName, string& format,
+                string& reduce, Selection<long long>& range, bool& verbose, string& statsName, bool& verify)
 {
-    int i1 = 0, i2 = 0;   // merge runs into outFile from inFile1 and inFile2
-    while (i1 < runSize && i2 < runSize)
+    for (int i = 1; i < argc; i++)
     {
-        if (record1 < record2)             // take whichever record is smaller
+        string flag = argv[i];
+        unsigned long long number = 0;
+
+        // Flags without a value:
+        if (flag == "--delta")
+            options.deltaRuns = true;
+        else if (flag == "-u" || flag == "--unique")
+            reduce = "unique";
+        else if (flag == "-c" || flag == "--count")
+            reduce = "count";
+        else if (flag == "--resume")
+            options.resume = true;
+        else if (flag == "-v" || flag == "--verbose")
+            verbose = true;
+        else if (flag == "--verify")
+            verify = true;
+        else if (i + 1 == argc)
+            return false;
+
+        // Flags with a value:
+        else
         {
-            outFile << record1 << "  ";    // take out from outFile1
-            inFile1 >> record1;
-            i1++;
-        }
-        else {
-            outFile << record2 << "  ";    // take out from outFile2
-            inFile2 >> record2;
-            i2++;
+            string value = argv[++i];
+            if (flag == "-i" || flag == "--input")
+                inName = value;
+            else if (flag == "-o" || flag == "--output")
+                outName = value;
+            else if (flag == "-m" || flag == "--memory")
+            {
+                if ((options.memBudget = parseByteSize(value)) == 0)
+                    return false;
+            }
+            else if (flag == "-T" || flag == "--temp-dir")
+                options.tempDir = value;
+            else if (flag == "-s" || flag == "--stats")
+                statsName = value;
+            else if (flag == "-k" || flag == "--fan-in")
+            {
+                if (!parseNumber(value, number) || number < 2)
+                    return false;
+                options.fanIn = static_cast<size_t>(number);
+            }
+            else if (flag == "-t" || flag == "--threads")
+            {
+                if (!parseNumber(value, number) || number == 0)
+                    return false;
+                options.threadNum = static_cast<size_t>(number);
+            }
+            else if (flag == "-f" || flag == "--format")
+            {
+                if ((format = value) != "int" && format != "log")
+                    return false;
+            }
+            else if (flag == "--method")
+            {
+                if (value != "block" && value != "replace")
+                    return false;
+                options.runMethod = (value == "block") ? BLOCK_SORT : REPLACEMENT_SELECTION;
+            }
+            else if (flag == "--tapes")
+            {
+                if (!parseNumber(value, number) || (number != 0 && number < 3))
+                    return false;
+                options.tapeNum = static_cast<size_t>(number);
+            }
+            else if (flag == "--top")
+            {
+                if (!parseNumber(value, number))
+                    return false;
+                range.limit = number;
+            }
+            else if (flag == "--low")
+            {
+                if (!parseKeyBound(value, range.hasLow, range.low))
+                    return false;
+            }
+            else if (flag == "--high")
+            {
+                if (!parseKeyBound(value, range.hasHigh, range.high))
+                    return false;
+            }
+            else
+                return false;
         }
     }
+    return true;
+}
 
-    if (i1 >= runSize)     // if either end of run is encountered, copy another's remaining.
-    {
-        while (i2 < runSize)
-        {
-            outFile << record2 << "  ";
-            inFile2 >> record2;
-            i2++;
-        }
-    }
-    else if (i2 >= runSize)
-    {
-        while (i1 < runSize)
-        {
-            outFile << record1 << "  ";
-            inFile1 >> record1;
-            i1++;
-        }
-    }
+/// Print how the sorter is run, in both of its modes.
+/// @param out the stream to print to
+/// @param program the name the sorter was run as
+void printUsage(ostream& out, const char* program)
+{
+    out << "Usage: " << program << " [memory budget in bytes, e.g. 4096, 64K, 512M, 2G] [replace|block] [threads] [tapes >= 3] [int|log] [plain|delta] [all|unique|count] [top K] [low key|-] [high key|-] [temp dir|-] [fresh|resume]" << endl
+        << "   or: " << program << " [flags]    (batch sort, no questions asked)" << endl
+        << "  -i, --input FILE      input file, - for standard input (default)" << endl
+        << "  -o, --output FILE     output file, - for standard output (default)" << endl
+        << "  -m, --memory BYTES    memory budget, e.g. 64M (default 64M)" << endl
+        << "  -T, --temp-dir DIR    directory of the temporary files (default current)" << endl
+        << "  -k, --fan-in N        max # of runs merged at once (default by memory)" << endl
+        << "  -t, --threads N       max # of sort and merge threads (default # of cores)" << endl
+        << "  -f, --format FORMAT   int for integers (default), log for log lines by timestamp" << endl
+        << "      --method METHOD   replace (default) or block run generation" << endl
+        << "      --tapes N         polyphase merge on N >= 3 tapes" << endl
+        << "      --delta           delta code runs of integers" << endl
+        << "  -u, --unique          keep one record per key" << endl
+        << "  -c, --count           write one count per key" << endl
+        << "      --top K           keep only the K smallest records" << endl
+        << "      --low KEY         drop records with smaller keys" << endl
+        << "      --high KEY        drop records with larger keys" << endl
+        << "      --resume          finish an interrupted sort into the same output" << endl
+        << "  -v, --verbose         report the runs and passes on standard error" << endl
+        << "  -s, --stats FILE      write the counters and timers of every phase as JSON, - for standard error" << endl
+        << "      --verify          check that the output is sorted and holds the records of the input" << endl
+        << "                        (needs -i and -o files, not with -c)" << endl;
 }
 
-/// Read a block of data from an input file,
-/// and return a pointer to a dynamic array containing that block.
-/// @param in input file stream
-int* readBlockFromFile(ifstream& in)
+
+/// Sort a file of records by the key KeyOf extracts, keeping every record, the first record
+/// of every key, or one count per key.
+/// @param inName name of the input file
+/// @param outName name of the sorted output file
+/// @param options memory budget, run method, # of threads, # of tapes, run coding, temporary directory and resume
+/// @param reduce "all", "unique" or "count"
+/// @param countComparisons whether to count the comparisons in the statistics
+/// @return the # of records, runs and merge passes
+template <typename Record, typename KeyOf>
+SortResult sortRecords(const string& inName, const string& outName, const SortOptions& options, const string& reduce,
+                       bool countComparisons)
 {
-    int* blockArray = new int[MAX_MEM_SIZE];
-    int record;
+    typedef SortOrder<Record, KeyOf> Order;
+    typedef SortOrder<Counted<Record>, CountedKey<KeyOf> > CountOrder;
 
-    for (int i = 0; i < MAX_MEM_SIZE; i++)    // read (20 ints)1 block from file
+    if (countComparisons)
     {
-        in >> record;
-        blockArray[i] = record;
+        if (reduce == "unique")
+            return sortFile<Record>(inName, outName, options, CountingOrder<Order>(), KeepFirst());
+        if (reduce == "count")
+            return sortFile<Counted<Record> >(inName, outName, options, CountingOrder<CountOrder>(), AddCounts());
+        return sortFile<Record, CountingOrder<Order> >(inName, outName, options);
     }
-
-    return blockArray;
+    if (reduce == "unique")
+        return sortFile<Record>(inName, outName, options, Order(), KeepFirst());
+    if (reduce == "count")
+        return sortFile<Counted<Record> >(inName, outName, options, CountOrder(), AddCounts());
+    return sortFile<Record, Order>(inName, outName, options);
 }
 
-/// Store the a dynamic array into an output file stream.
-/// @param arrPtr pointer to a dynamic array of int
-/// @param out output fie stream
-void storeToFile(int* arrPtr, ofstream& out)
+/// Write only the smallest records of a file, or those with keys in a range, in sorted order.
+/// @param inName name of the input file
+/// @param outName name of the output file
+/// @param options memory budget, # of threads, run coding and temporary directory
+/// @param range the # of smallest records to keep and the key range, as long long keys,
+///              clamped to the keys of the record type
+/// @param countComparisons whether to count the comparisons in the statistics
+/// @return the # of records read, runs and merge passes
+template <typename Record, typename KeyOf>
+SortResult selectRecords(const string& inName, const string& outName, const SortOptions& options,
+                         const Selection<long long>& range, bool countComparisons)
 {
-    for (int i = 0; i < MAX_MEM_SIZE; i++) // store 1 block in outFile1.
-        out << arrPtr[i] << "  ";
+    typedef SortOrder<Record, KeyOf> Order;
+
+    Selection<typename Order::Key> selection = keySelection<typename Order::Key>(range);
+    if (countComparisons)
+        return selectFile<Record, CountingOrder<Order> >(inName, outName, options, selection);
+    return selectFile<Record, Order>(inName, outName, options, selection);
 }
 
-/// Produce final sorted results from two input file stream.
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile output file stream
-void mergeFiles(ifstream& inFile1, ifstream& inFile2, ofstream& outFile)
+/// Write what a sort did as one JSON object: its settings, its result, and the counters
+/// and timers of every phase.
+/// @param statsName the file to write, "-" for standard error
+/// @param inName name of the input file
+/// @param outName name of the output file
+/// @param options memory budget, # of threads and the other settings of the sort
+/// @param result the # of records, runs and merge passes
+void writeStats(const string& statsName, const string& inName, const string& outName, const SortOptions& options,
+                const SortResult& result)
 {
-    int x, y;
-    inFile1 >> x;
-    inFile2 >> y;
-    while (!inFile1.eof() && !inFile2.eof()) // Read from files and place the smaller into outFile.
+    ofstream statsFile;
+    if (statsName != "-")
     {
-        if (x < y)
-        {
-            outFile << x << "  ";
-            inFile1 >> x;
-        }
-        else
-        {
-            outFile << y << "  ";
-            inFile2 >> y;
-        }
+        statsFile.open(statsName);
+        if (!statsFile)
+            throw runtime_error("Unable to create statistics file \"" + statsName + "\"");
     }
+    ostream& out = (statsName == "-") ? cerr : statsFile;
+    out << "{\"input\": " << jsonString(inName) << ", \"output\": " << jsonString(outName)
+        << ", \"memory_budget\": " << options.memBudget << ", \"threads\": " << options.threadNum
+        << ", \"records\": " << result.recordNum << ", \"runs\": " << result.runNum
+        << ", \"passes\": " << result.passNum << ", \"fan_in\": " << result.fanIn
+        << ", \"in_memory\": " << (result.inMemory ? "true" : "false") << ", \"stats\": ";
+    sortStats().writeJson(out);
+    out << "}" << endl;
+}
+
+/// Check the output of a sort in one pass over the output and one over the input: the output
+/// must be in order, with no two equal keys if one record was kept per key, and must have
+/// the # of records and the checksum of the input if every record was kept, or no more
+/// records than the input otherwise.
+/// @param inName name of the input file
+/// @param outName name of the output file
+/// @param reduce "all" or "unique"
+/// @param range the # of smallest records kept and the key range
+/// @param verbose whether to report a good output as well as a bad one
+/// @return true if the output passed every check
+template <typename Record, typename KeyOf>
+bool verifyRecords(const string& inName, const string& outName, const string& reduce,
+                   const Selection<long long>& range, bool verbose)
+{
+    typedef SortOrder<Record, KeyOf> Order;
 
-    if (inFile1.eof())  // if either end of file is encountered, copy another's remaining.
+    bool strict = (reduce == "unique");
+    bool selecting = range.limit > 0 || range.hasLow || range.hasHigh;
+    VerifyResult output = verifyFile<Record, Order>(outName, strict);
+    VerifyResult input = verifyFile<Record, Order>(inName);
+
+    if (!output.sorted)
     {
-        while (!inFile2.eof())
-        {
-            outFile << y << " ";
-            inFile2 >> y;
-        }
+        cerr << "Verification failed: record " << output.firstUnsorted << " of \"" << outName
+             << "\" is out of order." << endl;
+        return false;
     }
-    else if (inFile2.eof())
+    if ((strict || selecting) ? output.recordNum > input.recordNum
+                            : output.recordNum != input.recordNum || output.checksum != input.checksum)
     {
-        while (!inFile1.eof())
-        {
-            outFile << x << " ";
-            inFile1 >> x;
-        }
+        cerr << "Verification failed: \"" << outName << "\" has " << output.recordNum << " records with checksum "
+             << hex << output.checksum << dec << ", \"" << inName << "\" has " << input.recordNum
+             << " records with checksum " << hex << input.checksum << dec << "." << endl;
+        return false;
     }
+    if (verbose)
+        cerr << "Verified " << output.recordNum << " records of \"" << outName << "\" against "
+             << input.recordNum << " of \"" << inName << "\"." << endl;
+    return true;
 }
 
-/// Split files into blocks:
-/// @param blockNum number of unsorted block in a file
-/// @param inFile1 first input file
-/// @param inFile2 second input file
-/// @param outFile1 first output file
-/// @param outFile2 second output file
-void splitFiles(int& blockNum, ifstream& inFile1, ifstream& inFile2, ofstream& outFile1, ofstream& outFile2)
+/// Quote a string for JSON.
+/// @param text the string
+/// @return the string in quotes, with quotes, backslashes and control characters escaped
+string jsonString(const string& text)
 {
-    // Split the source file into 2 other sub-files, sort it, and alternately place in outFile1 and outFile2:
-    for (int i = 0; i < blockNum / 2; i++)  // 3 runs in each sub file.
+    string quoted = "\"";
+    for (size_t i = 0; i < text.size(); i++)
     {
-        // Read 1 block(20 ints) from inFile1, sort it, store in outFile1.
-        int* blockArray1 = readBlockFromFile(inFile1);  // Read 20 ints(1 block) from source file
-        msSort(blockArray1, MAX_MEM_SIZE);                 // sort it
-        storeToFile(blockArray1, outFile1);             // store the first run in outFile1.
-
-        // Read 1 block(20 ints) from inFile1, sort it, store in outFile2.
-        int* blockArray2 = readBlockFromFile(inFile1);  // Read 20 ints(1 block) from source file
-        msSort(blockArray2, MAX_MEM_SIZE);                 // sort it
-        storeToFile(blockArray2, outFile2);             // store the first run in outFile2.
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        if (c >= 0x20)
+            quoted += static_cast<char>(c);
+        else
+        {
+            const char* hex = "0123456789abcdef";
+            quoted += "\\u00";
+            quoted += hex[c >> 4];
+            quoted += hex[c & 15];
+        }
     }
-    closeFiles(inFile1, inFile2, outFile1, outFile2); // Close all opened files
+    return quoted + "\"";
 }
 
-/// Merge sort algorithm:
-template <typename T>
-void merge2(T* source, T* arrayptr, int l, int mid, int r)
+/// Convert a key bound such as "-42" into a key, or "-" into no bound.
+/// @param text the bound
+/// @param bounded set to whether there is a bound
+/// @param key set to the bound
+/// @return false if the text is neither an integer nor "-"
+bool parseKeyBound(const string& text, bool& bounded, long long& key)
 {
-    int i = l;
-    int j = mid + 1;
-    int k = l;
-
-    while ((i <= mid) && (j <= r))       // Compare current item from each list
-        if (source[i] < source[j])          // Then i item comes first
-            arrayptr[k++] = source[i++];
-        else                                      // j item comes first
-            arrayptr[k++] = source[j++];
-    // Move what is left of remaining list
+    bounded = (text != "-");
+    if (!bounded)
+        return true;
+    char* end = nullptr;
+    key = strtoll(text.c_str(), &end, 10);
+    return end != text.c_str() && *end == '\0';
+}
 
-    if (i > mid)
-        while (j <= r)
-            arrayptr[k++] = source[j++];
-    else
-        while (i <= mid)
-            arrayptr[k++] = source[i++];
+/// Convert a count such as "64" into a number.
+/// @param text the count
+/// @param value set to the number
+/// @return false if the text is not a count
+bool parseNumber(const string& text, unsigned long long& value)
+{
+    char* end = nullptr;
+    value = strtoull(text.c_str(), &end, 10);
+    return end != text.c_str() && *end == '\0' && text[0] != '-';
 }
 
-template <typename T>
-void mergesort2(T* source, T* dest, int l, int r)
+/// Opens a text file whose name is entered by the user.
+/// If the file does not exist, the user is given additional chances to enter a valid file.
+/// @param prompt used to tell the user what kind of file is required.
+/// @param inFile input file stream
+/// @return the name of the file
+string askUserForInputFile(string prompt, ifstream& inFile)
 {
-    if (l != r)
+    while (true)
     {
-        int mid = (l + r) / 2;
-        mergesort2(dest, source, l, mid);
-        mergesort2(dest, source, mid + 1, r);
-        merge2(source, dest, l, mid, r);
+        string file;
+        cout << prompt;
+        getline(cin, file);
+        inFile.open(file); // trying to open file path
+        if (!inFile.fail()) return file;
+        cout << "Unable to locate file \"" << file << "\""<< endl;
+        inFile.clear(); // recover from input file failure
     }
 }
 
-template <typename T>
-void msSort(T* arrayptr, const int& arraySize)
+/// Open the source file and check if it is correctly opened.
+/// @param inFile source input file
+/// @return the name of the source file
+string setupFiles(ifstream& inFile)
 {
-    T* copy = new T[arraySize];
-    int i;
-    for (i = 0; i < arraySize; i++)
-        copy[i] = arrayptr[i];
-
-    mergesort2(copy, arrayptr, 0, arraySize - 1);
+    string inName = askUserForInputFile("Input file(data.txt)? ", inFile);
+    cout << " *** File loaded successfully ***" << endl;
+    return inName;
 }
@@ -0,0 +1,76 @@
+/**********************************************************************
+ * File name: extSelect.h
+ * -----------------------
+ * This file defines the external selection: writing only the smallest
+ * K records of a text file, or only the records whose keys fall in a
+ * range, in sorted order, without sorting the whole file.
+ *
+ * The input is read once. Records outside the key range are dropped
+ * as they are read, and of the others a max-heap keeps only the K
+ * smallest, so a selection that fits in the memory budget is sorted
+ * and written without a single run file.
+ *
+ * A selection that does not fit falls back to runs: whenever the heap
+ * outgrows the budget it is sorted and written as a run of at most K
+ * records, and the largest record of a full run becomes a cutoff that
+ * drops every later record not below it. The runs are then merged,
+ * with every merge stopping after K records.
+ *
+ * This file defines the
+ *      selectFile function:      selects from one input file into one output file.
+ *      externalSelect function:  selects from one input stream into one output file.
+ *      Selection type:           the key range and the # of records to keep.
+ *      keySelection function:    narrows a selection to the keys of a record type.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTSELECT_H
+#define EXTSELECT_H
+
+#include <iostream>    // istream
+#include <string>      // file names
+#include <cstdint>     // uint64_t
+#include <limits>      // numeric_limits
+#include "extSort.h"
+using namespace std;
+
+
+/*
+ * Type: Selection
+ * ---------------
+ * Which records a selection keeps: those with keys in [low, high],
+ * where a missing bound does not limit the range, and of those only
+ * the limit smallest.
+ */
+template <typename Key>
+struct Selection
+{
+    uint64_t limit;          // # of smallest records to keep, 0 for all
+    bool hasLow;             // whether keys below low are dropped
+    Key low;                 // the smallest key kept
+    bool hasHigh;            // whether keys above high are dropped
+    Key high;                // the largest key kept
+};
+
+
+// Function Prototypes:
+template <typename Key>
+Selection<Key> keySelection(const Selection<long long>& range);
+template <typename Record, typename Order>
+SortResult selectFile(const string& inName, const string& outName, const SortOptions& options,
+                      const Selection<typename Order::Key>& selection, const Order& order = Order());
+template <typename Record, typename Order>
+SortResult externalSelect(istream& in, const string& outName, const SortOptions& options,
+                          const Selection<typename Order::Key>& selection, const Order& order = Order());
+template <typename Record, typename Order>
+bool inSelection(const Record& record, const Selection<typename Order::Key>& selection, const Order& order);
+template <typename Record, typename Order>
+void sortSelection(SortBlock<Record, Order>& block, SortBlock<Record, Order>& scratch, uint64_t limit,
+                   const Order& order);
+
+#include "extSelect.t"
+
+#endif //EXTSELECT_H
@@ -0,0 +1,265 @@
+/**********************************************************************
+ * File name: extSelect.t
+ * -----------------------
+ * This file implements the external selection.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTSELECT_T
+#define EXTSELECT_T
+
+#include <algorithm>   // push_heap, pop_heap
+#include <fstream>     // ifstream
+#include <stdexcept>   // runtime_error
+
+
+/*******************************************************************************************
+ * Function Name: selectFile
+ * ------------------
+ * Purpose: To write the selected records of a text file, in sorted order, into a text file
+ *          within a memory budget.
+ *
+ * Input Parameters:
+ *          inName: name of the input file, or STANDARD_STREAM.
+ *          outName: name of the output file, or STANDARD_STREAM.
+ *          options: memory budget, # of threads, run coding, temporary directory and fan-in.
+ *          selection: the key range and the # of smallest records to keep.
+ *          order: the order of the records.
+ * Output parameters: none.
+ * Return Value:
+ *          SortResult: the # of records read, runs and merge passes.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+SortResult selectFile(const string& inName, const string& outName, const SortOptions& options,
+                      const Selection<typename Order::Key>& selection, const Order& order)
+{
+    if (inName == STANDARD_STREAM)
+        return externalSelect<Record>(cin, outName, options, selection, order);
+
+    ifstream inFile(inName);
+    if (!inFile)
+        throw runtime_error("Unable to open input file \"" + inName + "\"");
+    return externalSelect<Record>(inFile, outName, options, selection, order);
+}
+
+
+/*******************************************************************************************
+ * Function Name: externalSelect
+ * ------------------
+ * Purpose: To write the selected records of a text stream, in sorted order, into a text
+ *          file within a memory budget. The records in the key range are kept in a block,
+ *          which is a max-heap of at most limit records when there is a limit, so a record
+ *          that is not among the smallest so far is dropped at once. A block that outgrows
+ *          the budget is sorted and written as a run of at most limit records; a full run
+ *          gives a cutoff, its largest record, that no later record needs to reach. If no
+ *          run was written the last block is the output, otherwise the runs are merged and
+ *          every merge stops after limit records.
+ *
+ * Input Parameters:
+ *          in: the input stream.
+ *          outName: name of the output file, or STANDARD_STREAM.
+ *          options: memory budget, # of threads, run coding, temporary directory and fan-in.
+ *          selection: the key range and the # of smallest records to keep.
+ *          order: the order of the records.
+ * Output parameters: none.
+ * Return Value:
+ *          SortResult: the # of records read, runs and merge passes.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+SortResult externalSelect(istream& in, const string& outName, const SortOptions& options,
+                          const Selection<typename Order::Key>& selection, const Order& order)
+{
+    TextReader<Record> inFile(in);
+    SortResult result = { 0, 0, 0, 0, false };
+    uint64_t limit = selection.limit;
+
+    // A heap pays only if it can fill up before the block outgrows the budget:
+    bool useHeap = limit > 0
+        && (RecordCodec<Record>::width == 0 || limit <= options.memBudget / sizeof(Record));
+
+    uint32_t runFlags = RUN_SORTED;
+    if (options.deltaRuns && DeltaVarint<Record>::supported)
+        runFlags |= RUN_DELTA;
+    SortManifest manifest(options.tempDir, outName, false);
+    try {
+        RunDistributor<Record> runs(manifest, 0, runFlags);
+        sortStats().beginPhase("selection");
+
+        SortBlock<Record, Order> block, scratch;
+        vector<Record>& heap = block.records;
+        size_t used = 0;             // bytes of the records in the block
+        bool bounded = false;        // whether a full run has been written
+        Record cutoff = Record();    // the smallest largest record of a full run
+        Record record;
+        while (inFile.read(record))
+        {
+            result.recordNum++;
+            if (!inSelection(record, selection, order) || (bounded && !order(record, cutoff)))
+                continue;
+
+            if (useHeap && heap.size() == limit)     // the heap is full: the record replaces its largest one
+            {
+                if (!order(record, heap.front()))
+                    continue;
+                pop_heap(heap.begin(), heap.end(), order);
+                used -= RecordCodec<Record>::memory(heap.back());
+                used += RecordCodec<Record>::memory(record);
+                heap.back() = record;
+                push_heap(heap.begin(), heap.end(), order);
+            }
+            else
+            {
+                used += RecordCodec<Record>::memory(record);
+                heap.push_back(record);
+                if (useHeap)
+                    push_heap(heap.begin(), heap.end(), order);
+            }
+
+            if (used > options.memBudget)            // write the block as a run of at most limit records
+            {
+                sortSelection(block, scratch, limit, order);
+                size_t kept = block.keys.empty() ? block.records.size() : block.keys.size();
+                if (limit > 0 && kept == limit)
+                {
+                    const Record& largest = block.keys.empty() ? block.records.back()
+                                                               : block.records[block.keys.back().second];
+                    if (!bounded || order(largest, cutoff))
+                        cutoff = largest;
+                    bounded = true;
+                }
+                storeToFile(block, runs, order, KeepAll());
+                block.records.clear();
+                used = 0;
+            }
+        }
+
+        if (runs.runCount() == 0)                    // everything selected fit in memory: no runs
+        {
+            sortSelection(block, scratch, limit, order);
+            TextWriter<Record> outFile(outName);
+            if (block.keys.empty())
+                for (size_t i = 0; i < block.records.size(); i++)
+                    outFile.write(block.records[i]);
+            else
+                for (size_t i = 0; i < block.keys.size(); i++)
+                    outFile.write(block.records[block.keys[i].second]);
+            outFile.close();
+            result.inMemory = true;
+            sortStats().addRecordsRead(result.recordNum);
+            sortStats().endPhase();
+            return result;
+        }
+
+        if (!block.records.empty())
+        {
+            sortSelection(block, scratch, limit, order);
+            storeToFile(block, runs, order, KeepAll());
+        }
+        result.runNum = runs.runCount();
+        sortStats().addRecordsRead(result.recordNum);
+        sortStats().endPhase();
+        result.fanIn = (options.fanIn > 0) ? max(options.fanIn, size_t(2)) : chooseFanIn(options.memBudget);
+        result.passNum = mergeAllRuns<Record>(runs.fileNames(), result.fanIn, options.memBudget, options.threadNum,
+                                              outName, runFlags, manifest, order, KeepAll(), limit);
+        return result;
+    }
+    catch (...) {
+        manifest.discard();                      // a failed selection leaves no run files
+        throw;
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: keySelection
+ * ------------------
+ * Purpose: To narrow a selection of long long keys, as given by the user, to one of the
+ *          keys of a record type, a signed integer no wider than long long. A bound beyond
+ *          every key is clamped rather than cast: a low bound above the largest key, or a
+ *          high bound below the smallest, selects nothing, and one at the other end does
+ *          not limit the range.
+ *
+ * Input Parameters:
+ *          range: the # of smallest records to keep and the key range, as long long keys.
+ * Output parameters: none.
+ * Return Value:
+ *          Selection<Key>: the same selection of keys of type Key.
+ *******************************************************************************************/
+template <typename Key>
+Selection<Key> keySelection(const Selection<long long>& range)
+{
+    const long long lowest = numeric_limits<Key>::min();
+    const long long highest = numeric_limits<Key>::max();
+
+    Selection<Key> selection = { range.limit, range.hasLow, numeric_limits<Key>::min(),
+                                 range.hasHigh, numeric_limits<Key>::max() };
+    if ((range.hasLow && range.low > highest) || (range.hasHigh && range.high < lowest))
+    {
+        selection.hasLow = selection.hasHigh = true;     // low above high: no key is in the range
+        selection.low = numeric_limits<Key>::max();
+        selection.high = numeric_limits<Key>::min();
+        return selection;
+    }
+    if (range.hasLow && range.low > lowest)
+        selection.low = static_cast<Key>(range.low);
+    if (range.hasHigh && range.high < highest)
+        selection.high = static_cast<Key>(range.high);
+    return selection;
+}
+
+
+/*******************************************************************************************
+ * Function Name: inSelection
+ * ------------------
+ * Purpose: To test whether the key of a record is in the key range of a selection.
+ *
+ * Input Parameters:
+ *          record: the record.
+ *          selection: the key range.
+ *          order: the order of the records.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: true if the record is not below low and not above high.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+bool inSelection(const Record& record, const Selection<typename Order::Key>& selection, const Order& order)
+{
+    if (!selection.hasLow && !selection.hasHigh)
+        return true;
+    typename Order::Key key = order.key(record);
+    return !(selection.hasLow && order.keyLess(key, selection.low))
+        && !(selection.hasHigh && order.keyLess(selection.high, key));
+}
+
+
+/*******************************************************************************************
+ * Function Name: sortSelection
+ * ------------------
+ * Purpose: To sort a block of selected records and keep only the smallest limit of them.
+ *
+ * Input Parameters:
+ *          block: the selected records.
+ *          scratch: a block whose vectors serve as scratch space.
+ *          limit: # of smallest records to keep, 0 for all.
+ *          order: the order of the records.
+ * Output parameters:
+ *          block: the sorted records, or the sorted (key, position) pairs, cut after limit.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+void sortSelection(SortBlock<Record, Order>& block, SortBlock<Record, Order>& scratch, uint64_t limit,
+                   const Order& order)
+{
+    sortBlock(block, scratch, order);
+    if (limit == 0)
+        return;
+    if (block.keys.empty() && block.records.size() > limit)
+        block.records.erase(block.records.begin() + limit, block.records.end());
+    else if (block.keys.size() > limit)
+        block.keys.erase(block.keys.begin() + limit, block.keys.end());
+}
+
+#endif //EXTSELECT_T
@@ -0,0 +1,414 @@
+/**********************************************************************
+ * File name: extSort.h
+ * -----------------------
+ * This file defines the external merge sort: sorting a text file of
+ * records that does not fit in memory into a sorted text file, using
+ * no more than a given memory budget.
+ *
+ * The input is split into sorted runs, either by sorting one memory
+ * sized block at a time or by replacement selection, and the runs
+ * are stored as binary run files (runFile.h). The runs are then
+ * merged, up to a fan-in at a time, or by a polyphase merge over a
+ * fixed number of tape files, until one sorted text file is left.
+ *
+ * The sort is template based so that the user may decide the record
+ * type, the key of a record and the order of keys:
+ *
+ *      Record:      the record class. It is read and written as text
+ *                   by RecordText<Record> (recordText.h) and stored in run files by
+ *                   RecordCodec<Record>, either as fixed-size records
+ *                   or as length-prefixed variable-size records.
+ *      SortOrder:   a key extractor and a "less than" comparison of
+ *                   keys, which together order the records.
+ *
+ * An input file that fits in the memory budget skips all of this: it
+ * is memory-mapped, parsed and sorted in parallel slices, and the
+ * slices are merged straight into the output file in one pass.
+ *
+ * Runs of integer records may be delta coded (deltaRuns), which cuts
+ * the bytes of run files several times on sorted data, at the cost of
+ * the parallel merge, which needs to read runs at any position.
+ *
+ * Records much larger than their keys are sorted by permutation:
+ * run generation sorts (key, position) pairs and writes the records
+ * in that order, so the records themselves are never moved.
+ *
+ * A sort may also collapse records with equal keys (reducers.h): to
+ * one record per key, to a count per key, or by any combine function.
+ * Records are combined when runs are written and in every merge.
+ *
+ * Blocks whose keys are integers in ascending or descending order are
+ * sorted by an LSD radix sort, one byte of the key per pass, instead
+ * of a merge sort. Every sort thread keeps one scratch block for it.
+ *
+ * Temporary files get names unique to the sort, in a scratch directory
+ * (tempDir), and are deleted as soon as they have been merged. The
+ * k-way merge records its progress in a manifest (sortManifest.h), so
+ * a sort that was interrupted during the merge can be resumed from the
+ * last group of runs it merged instead of from the start.
+ *
+ * Every phase of a sort (run generation, each merge pass, the final
+ * merge) is counted and timed in the statistics of sortStats.h.
+ *
+ * This file defines the
+ *      sortFile function:      sorts one input file into one output file.
+ *      externalSort function:  sorts one input stream into one output file.
+ *      SortOrder type:         orders records by a key.
+ *      RunDistributor type:    places the runs made by run generation.
+ *      parseByteSize function: reads a memory budget such as "64M".
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTSORT_H
+#define EXTSORT_H
+
+#include <iostream>    // istream
+#include <fstream>     // ifstream, ofstream
+#include <string>      // file names; string records
+#include <vector>      // vector<Record> blocks
+#include <utility>     // pair<Key, uint32_t>, move
+#include <cstdint>     // uint32_t, uint64_t
+#include <functional>  // less<>
+#include <type_traits> // decay, is_integral, make_unsigned
+#include <mutex>       // mutex guarding FirstError
+#include <atomic>      // atomic<bool> failed
+#include <exception>   // exception_ptr
+#include <cstdlib>     // strtoull
+#include "runFile.h"
+#include "recordText.h"
+#include "loserTree.h"
+#include "boundedQueue.h"
+#include "mappedFile.h"
+#include "reducers.h"
+#include "sortManifest.h"
+#include "sortStats.h"
+#include "sort_algorithms.t"
+using namespace std;
+
+
+const size_t MIN_RUN_BUFFER = 4096;                  // smallest useful read buffer per run while merging
+const size_t RESERVED_FILES = 8;                     // stdin/out/err, the output file and some spares
+const size_t MIN_PARALLEL_BLOCK = 1 << 16;           // smallest block (in records) worth a sort or merge thread of its own
+const size_t SAMPLES_PER_PART = 64;                  // splitter samples taken per key range of a parallel merge
+const size_t PERMUTE_RECORD_BYTES = 32;              // records larger than this are sorted by permutation of their keys
+const size_t MIN_PARALLEL_TEXT = 1 << 20;            // smallest slice of text (in bytes) worth a parse thread of its own
+const size_t BUDGET_CHECK_RECORDS = 4096;            // records parsed between checks of the shared memory budget
+const size_t MIN_RADIX_RECORDS = 256;                // smallest block worth a radix sort rather than a merge sort
+
+// How the sorted runs are generated:
+enum RunMethod { BLOCK_SORT,              // sort one memory-sized block at a time
+                 REPLACEMENT_SELECTION }; // stream records through a heap, runs are ~2x memory on random data
+
+/*
+ * Type: SortOptions
+ * -----------------
+ * The resources an external sort may use.
+ */
+struct SortOptions
+{
+    size_t memBudget;        // memory budget in bytes
+    RunMethod runMethod;     // how the sorted runs are generated
+    size_t threadNum;        // max # of sort and merge threads
+    size_t tapeNum;          // # of tape files for a polyphase merge, 0 for a k-way merge
+    bool deltaRuns;          // delta code the runs of integer records
+    bool tryInMemory;        // sort an input file that fits in the memory budget without run files
+    string tempDir;          // directory of the temporary files, "" for the current directory
+    bool resume;             // resume the interrupted sort into the same output file, if there is one
+    size_t fanIn;            // max # of runs merged at once, 0 to choose by the memory budget
+};
+
+/*
+ * Type: SortResult
+ * ----------------
+ * What an external sort did.
+ */
+struct SortResult
+{
+    uint64_t recordNum;      // # of records sorted
+    size_t runNum;           // # of runs made by run generation
+    int passNum;             // # of merge passes, or of polyphase merge phases
+    size_t fanIn;            // max # of runs merged at once
+    bool inMemory;           // whether the input was sorted in memory, without runs
+};
+
+
+/*
+ * Type: IdentityKey
+ * -----------------
+ * The key extractor for records that are their own key.
+ */
+struct IdentityKey
+{
+    template <typename T>
+    const T& operator()(const T& record) const { return record; }
+};
+
+/*
+ * Type: SortOrder
+ * ---------------
+ * This type orders records by a key. KeyOf extracts the key of a
+ * record, and Compare is the "less than" order of keys.
+ */
+template <typename Record, typename KeyOf = IdentityKey, typename Compare = less<> >
+struct SortOrder
+{
+    typedef typename decay<decltype(declval<KeyOf>()(declval<const Record&>()))>::type Key;
+    typedef Compare KeyCompare;
+
+    KeyOf keyOf;             // extracts the key of a record
+    Compare cmp;             // "less than" order of keys
+
+    /* Constructor */
+    explicit SortOrder(KeyOf keyOf = KeyOf(), Compare cmp = Compare()) : keyOf(keyOf), cmp(cmp) {}
+
+    /* Return the key of a record */
+    Key key(const Record& record) const { return keyOf(record); }
+
+    /* Test whether key a comes before key b */
+    bool keyLess(const Key& a, const Key& b) const { return cmp(a, b); }
+
+    /* Test whether record a comes before record b */
+    bool operator()(const Record& a, const Record& b) const { return cmp(keyOf(a), keyOf(b)); }
+};
+
+
+/*
+ * Type: RadixKey
+ * --------------
+ * Tells whether keys of type Key in the order Compare can be radix
+ * sorted (usable), and if so maps a key to the unsigned integer of its
+ * rank (bits): integers in ascending or descending order qualify.
+ */
+template <typename Key, typename Compare, bool = is_integral<Key>::value && !is_same<Key, bool>::value>
+struct RadixKey
+{
+    static const bool usable = false;
+};
+
+template <typename Key, typename Compare>
+struct RadixKey<Key, Compare, true>
+{
+    typedef typename make_unsigned<Key>::type Bits;
+
+    static const bool ascending = is_same<Compare, less<> >::value || is_same<Compare, less<Key> >::value;
+    static const bool descending = is_same<Compare, greater<> >::value || is_same<Compare, greater<Key> >::value;
+    static const bool usable = ascending || descending;
+
+    static Bits bits(Key key)
+    {
+        Bits rank = static_cast<Bits>(key);
+        if (is_signed<Key>::value)
+            rank ^= Bits(1) << (8 * sizeof(Key) - 1);   // negative keys rank below positive ones
+        return descending ? Bits(~rank) : rank;
+    }
+};
+
+
+/*
+ * Type: RunDistributor
+ * --------------------
+ * Hands out the writers for the runs made by run generation. By default
+ * every run gets a file of its own for the k-way merge. With tapeNum
+ * tapes the runs are laid out over tapeNum - 1 tape files instead, in a
+ * perfect Fibonacci distribution topped up with dummy (empty) runs, as
+ * the polyphase merge needs (Knuth's Algorithm D, the last tape starts empty).
+ */
+template <typename Record>
+class RunDistributor
+{
+private:
+    const SortManifest& manifest; // names the run files and the tape files
+    size_t tapeNum;              // 0 for one file per run, else the # of tape files
+    uint32_t flags;              // header flags of every run
+    vector<string> names;        // the run files, or the tape files
+    size_t tape;                 // the tape that receives the next run
+    vector<size_t> perfect;      // runs per tape in the perfect distribution of this level
+
+public:
+    vector<size_t> dummyRuns;    // runs of the perfect distribution not written, per tape
+    vector<size_t> realRuns;     // runs written, per tape
+
+    /* Constructor */
+    explicit RunDistributor(const SortManifest& manifest, size_t tapeNum = 0, uint32_t flags = RUN_SORTED);
+
+    /* Open a writer for the next run */
+    RunWriter<Record>* beginRun(size_t bufferBytes);
+
+    /* Close and free the writer of a run */
+    void endRun(RunWriter<Record>* run);
+
+    /* Return the header flags of every run */
+    uint32_t runFlags() const { return flags; }
+
+    /* Test whether the runs are on tapes */
+    bool usesTapes() const { return tapeNum > 0; }
+
+    /* Return the run files, or the tape files */
+    const vector<string>& fileNames() const { return names; }
+
+    /* Return the # of runs written */
+    size_t runCount() const;
+};
+
+
+/*
+ * Type: FirstError
+ * ----------------
+ * The first exception thrown by the threads of a parallel stage. A
+ * thread keeps what it caught here and the other threads give up once
+ * they see the failure; after they are joined the exception is thrown
+ * on the calling thread, since one escaping a thread ends the program.
+ */
+class FirstError
+{
+private:
+    mutex lock;              // guards error
+    exception_ptr error;     // the first exception caught, or null
+    atomic<bool> failed;     // whether an exception was caught
+
+public:
+    /* Constructor */
+    FirstError() : failed(false) {}
+
+    /* Keep the exception being handled, unless one was kept before */
+    void keep();
+
+    /* Test whether an exception was kept */
+    bool any() const { return failed; }
+
+    /* Throw the exception kept, if any */
+    void rethrow();
+};
+
+
+/*
+ * Type: TextChunks
+ * ----------------
+ * The writer of one key range of a parallel merge into text. It formats
+ * the records in chunks of chunkBytes and hands every chunk to a bounded
+ * queue, from which the calling thread writes the ranges in key order,
+ * so the text is written once without a part file per range.
+ */
+template <typename Record>
+class TextChunks
+{
+private:
+    BoundedQueue<string>& chunks;   // the chunks of the range, closed after the last one
+    size_t chunkBytes;              // bytes of text per chunk
+    string buffer;                  // text not handed over yet
+    uint64_t count;                 // # of records written
+
+    /* Move the buffered text into the queue and start a new buffer */
+    void hand()
+    {
+        if (!chunks.push(std::move(buffer)))   // closed early: another range failed
+            throw runtime_error("The parallel merge was stopped");
+        buffer.clear();
+        buffer.reserve(chunkBytes + 64);
+    }
+
+public:
+    /* Constructor */
+    TextChunks(BoundedQueue<string>& chunks, size_t chunkBytes) : chunks(chunks), chunkBytes(chunkBytes), count(0)
+    {
+        buffer.reserve(chunkBytes + 64);
+    }
+
+    /* Append one record */
+    void write(const Record& record)
+    {
+        RecordText<Record>::format(record, buffer);
+        count++;
+        if (buffer.size() >= chunkBytes)
+            hand();
+    }
+
+    /* Hand over the last chunk and close the queue */
+    void close()
+    {
+        if (!buffer.empty())
+            hand();
+        chunks.close();
+        sortStats().addRecordsWritten(count);
+    }
+};
+
+
+/*
+ * Type: SortBlock
+ * ---------------
+ * A block of records being made into a run. When the records are sorted
+ * by permutation, keys holds the key and position of every record in
+ * sorted order and the records stay where they were read.
+ *
+ * A block also serves as the scratch space of the sorts of other blocks.
+ */
+template <typename Record, typename Order>
+struct SortBlock
+{
+    vector<Record> records;                                 // the records
+    vector<pair<typename Order::Key, uint32_t> > keys;      // sorted (key, position) pairs, or empty
+};
+
+
+// Function Prototypes:
+size_t openFileLimit();
+size_t chooseFanIn(size_t memBudget);
+size_t parseByteSize(const string& text);
+
+template <typename Record, typename Order, typename Reducer = KeepAll>
+SortResult sortFile(const string& inName, const string& outName, const SortOptions& options, const Order& order = Order(),
+                    const Reducer& reducer = Reducer());
+template <typename Record, typename Order, typename Reducer = KeepAll>
+SortResult externalSort(istream& in, const string& outName, const SortOptions& options, const Order& order = Order(),
+                        const Reducer& reducer = Reducer());
+template <typename Record, typename Order, typename Reducer>
+bool sortInMemory(const MappedFile& inFile, const string& outName, const SortOptions& options, const Order& order,
+                  const Reducer& reducer, SortResult& result);
+
+template <typename Record, typename Order>
+bool permuteKeys();
+template <typename Record>
+bool readBlockFromFile(TextReader<Record>& in, vector<Record>& block, size_t memBudget);
+template <typename Record, typename Order>
+void sortBlock(SortBlock<Record, Order>& block, SortBlock<Record, Order>& scratch, const Order& order);
+template <typename Record, typename Order, typename Reducer>
+void storeToFile(const SortBlock<Record, Order>& block, RunDistributor<Record>& runs, const Order& order,
+                 const Reducer& reducer);
+template <typename Record, typename Order, typename Reducer>
+void splitFiles(size_t memBudget, uint64_t& recordNum, TextReader<Record>& inFile, RunDistributor<Record>& runs,
+                const Order& order, const Reducer& reducer);
+template <typename Record, typename Order, typename Reducer>
+void splitFilesParallel(size_t memBudget, size_t workerNum, uint64_t& recordNum, TextReader<Record>& inFile,
+                        RunDistributor<Record>& runs, const Order& order, const Reducer& reducer);
+template <typename Record, typename Order, typename Reducer>
+void replacementSelection(size_t memBudget, uint64_t& recordNum, TextReader<Record>& inFile,
+                          RunDistributor<Record>& runs, const Order& order, const Reducer& reducer);
+template <typename Record, typename Order, typename Reducer, typename Writer>
+void mergeRuns(vector<RunReader<Record>*>& inRuns, Writer& out, const Order& order, const Reducer& reducer,
+               uint64_t limit = 0);
+template <typename Record, typename Order, typename Reducer, typename Writer>
+void mergeRunFiles(const vector<string>& runNames, size_t first, size_t last, Writer& out, size_t bufferSize,
+                   const Order& order, const Reducer& reducer, uint64_t limit = 0);
+template <typename Record, typename Order, typename Reducer>
+bool mergeRunFilesParallel(const vector<string>& runNames, size_t first, size_t last, const string& outName,
+                           bool textOutput, size_t memBudget, size_t threadNum,
+                           const Order& order, const Reducer& reducer);
+template <typename Record, typename Order, typename Reducer>
+int mergeAllRuns(vector<string> runNames, size_t fanIn, size_t memBudget, size_t threadNum, const string& outName,
+                 uint32_t runFlags, SortManifest& manifest, const Order& order, const Reducer& reducer,
+                 uint64_t limit = 0);
+template <typename Record, typename Order, typename Reducer>
+int polyphaseMerge(RunDistributor<Record>& runs, size_t memBudget, const string& outName, const Order& order,
+                   const Reducer& reducer);
+template <typename T, typename Less>
+void stableSortBlock(T* arrayptr, size_t arraySize, vector<T>& scratch, const Less& less);
+template <typename T, typename BitsOf>
+void radixSort(T* arrayptr, size_t arraySize, vector<T>& scratch, const BitsOf& bitsOf);
+
+#include "extSort.t"
+
+#endif //EXTSORT_H
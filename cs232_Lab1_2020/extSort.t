@@ -0,0 +1,1438 @@
+/**********************************************************************
+ * File name: extSort.t
+ * -----------------------
+ * This file implements the external merge sort: run generation, the
+ * k-way and polyphase merges, and the RunDistributor class.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTSORT_T
+#define EXTSORT_T
+
+#include <algorithm>   // make_heap, push_heap, pop_heap, sort
+#include <thread>      // thread
+#include <atomic>      // atomic<size_t>
+#include <deque>       // deque<BoundedQueue<string> > chunks
+#include <cstdio>      // remove, FOPEN_MAX
+#include <stdexcept>   // runtime_error
+#include <climits>     // INT_MAX
+#ifndef _WIN32
+#include <sys/resource.h>   // getrlimit
+#endif
+
+
+/*******************************************************************************************
+ * Function Name: sortFile
+ * ------------------
+ * Purpose: To sort a text file of records into a sorted text file within a memory budget.
+ *          A file no larger than the budget is first sorted in memory; text takes about as
+ *          many bytes as the records it holds, so such a file usually fits. If its records
+ *          turn out not to fit after all, or the file is larger, it is sorted externally.
+ *          With resume, a sort into the same output file that was interrupted during its
+ *          merge is finished instead, without reading the input file again; one that was
+ *          interrupted before, or whose files are damaged, is cleaned up and started over
+ *          when the sort is run again. Standard input (STANDARD_STREAM) cannot be mapped,
+ *          so it is always sorted externally.
+ *
+ * Input Parameters:
+ *          inName: name of the input file, or STANDARD_STREAM.
+ *          outName: name of the sorted output file, or STANDARD_STREAM.
+ *          options: memory budget, run method, # of threads, # of tapes, run coding,
+ *                   temporary directory, fan-in and whether to resume.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters: none.
+ * Return Value:
+ *          SortResult: the # of records, runs and merge passes.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+SortResult sortFile(const string& inName, const string& outName, const SortOptions& options, const Order& order,
+                    const Reducer& reducer)
+{
+    if (options.resume)
+    {
+        SortManifest manifest(options.tempDir, outName, true);
+        SortResult result = { 0, 0, 0, 0, false };
+        uint32_t runFlags;
+        if (manifest.find())
+        {
+            try {
+                if (manifest.load(result.recordNum, result.runNum, result.fanIn, runFlags))
+                {
+                    result.passNum = mergeAllRuns<Record>(vector<string>(), result.fanIn, options.memBudget,
+                                                          options.threadNum, outName, runFlags, manifest, order,
+                                                          reducer);
+                    return result;
+                }
+            }
+            catch (...) {
+                manifest.discard();              // damaged, or the merge failed: the next sort starts over
+                throw;
+            }
+            manifest.discard();                  // interrupted during run generation: start over
+        }
+    }
+
+    if (inName == STANDARD_STREAM)
+        return externalSort<Record>(cin, outName, options, order, reducer);
+
+    if (options.tryInMemory)
+    {
+        MappedFile mapped(inName, options.memBudget);
+        SortResult result;
+        if (mapped.isOpen() && sortInMemory<Record>(mapped, outName, options, order, reducer, result))
+            return result;
+    }
+
+    ifstream inFile(inName);
+    if (!inFile)
+        throw runtime_error("Unable to open input file \"" + inName + "\"");
+    return externalSort<Record>(inFile, outName, options, order, reducer);
+}
+
+
+/*******************************************************************************************
+ * Function Name: sortInMemory
+ * ------------------
+ * Purpose: To sort a mapped text file entirely in memory. The text is cut into one slice
+ *          per thread between two records; every thread parses its slice straight from the
+ *          mapping and sorts it in place, and the sorted slices are merged by a loser tree straight into the text
+ *          output file. The threads share the memory budget and give up as soon as their
+ *          records exceed it.
+ *
+ * Input Parameters:
+ *          inFile: the mapped input file.
+ *          outName: name of the sorted output file.
+ *          options: memory budget and # of threads.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters:
+ *          result: the # of records sorted.
+ * Return Value:
+ *          bool: false, without writing the output, if the records do not fit in the budget.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+bool sortInMemory(const MappedFile& inFile, const string& outName, const SortOptions& options, const Order& order,
+                  const Reducer& reducer, SortResult& result)
+{
+    const char* text = inFile.data();
+    size_t size = inFile.size();
+    size_t partNum = size / MIN_PARALLEL_TEXT + 1;
+    if (partNum > options.threadNum)
+        partNum = (options.threadNum > 0) ? options.threadNum : 1;
+    sortStats().beginPhase("in-memory sort", partNum);
+    sortStats().addBytesRead(size);              // the pages of the mapping are read as they are touched
+
+    // Cut the text into slices that start and end between two records:
+    vector<size_t> cuts(partNum + 1, size);
+    cuts[0] = 0;
+    for (size_t p = 1; p < partNum; p++)
+    {
+        size_t cut = max(cuts[p - 1], p * (size / partNum));
+        while (cut < size && !RecordText<Record>::isSeparator(text[cut]))
+            cut++;
+        cuts[p] = (cut < size) ? cut + 1 : size;     // the slice starts after the separator
+    }
+
+    // Parse and sort every slice on its own thread:
+    vector<vector<Record> > parts(partNum);
+    atomic<size_t> used(0);
+    atomic<bool> overBudget(false);
+    FirstError errors;
+    auto work = [&](size_t p) {
+        try {
+            const char* next = text + cuts[p];
+            const char* end = text + cuts[p + 1];
+            size_t local = 0;
+            Record record;
+            while ((next = RecordText<Record>::parse(next, end, record, true)) != nullptr)
+            {
+                local += RecordCodec<Record>::memory(record);
+                parts[p].push_back(record);
+                if (parts[p].size() % BUDGET_CHECK_RECORDS == 0)
+                {
+                    if ((used += local) > options.memBudget)
+                        overBudget = true;
+                    local = 0;
+                    if (overBudget || errors.any())
+                        return;
+                }
+            }
+            if ((used += local) > options.memBudget)
+                overBudget = true;
+            if (!overBudget)
+                sort(parts[p].begin(), parts[p].end(), order);
+        }
+        catch (...) {                            // a bad token: thrown once every thread is joined
+            errors.keep();
+        }
+    };
+    vector<thread> workers;
+    for (size_t p = 1; p < partNum; p++)
+        workers.emplace_back(work, p);
+    work(0);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    errors.rethrow();
+    if (overBudget)
+    {
+        sortStats().endPhase();
+        return false;
+    }
+
+    // Merge the sorted slices into the output file in one pass:
+    LoserTree<Record, Order> tree(partNum, order);
+    vector<size_t> next(partNum, 1);
+    for (size_t p = 0; p < partNum; p++)
+    {
+        if (parts[p].empty())
+            tree.setExhausted(p);
+        else
+            tree.setLeaf(p, parts[p][0]);
+    }
+    tree.build();
+    TextWriter<Record> outFile(outName);
+    Reduction<Record, Order, Reducer> reduction(order, reducer);
+    while (!tree.empty())
+    {
+        size_t p = tree.top();
+        reduction.write(outFile, tree.topKey());
+        if (next[p] < parts[p].size())
+            tree.replaceTop(parts[p][next[p]++]);
+        else
+            tree.exhaustTop();
+    }
+    reduction.flush(outFile);
+    outFile.close();
+
+    result.recordNum = 0;
+    for (size_t p = 0; p < partNum; p++)
+        result.recordNum += parts[p].size();
+    result.runNum = 0;
+    result.passNum = 0;
+    result.fanIn = partNum;
+    result.inMemory = true;
+    sortStats().addRecordsRead(result.recordNum);
+    sortStats().endPhase();
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: externalSort
+ * ------------------
+ * Purpose: To sort a text stream of records into a sorted text file within a memory budget.
+ *          The input is split into sorted runs by the chosen run method, then the runs
+ *          are merged up to a fan-in at a time, or by a polyphase merge over the tapes.
+ *          The k-way merge is recorded in a manifest named with the prefix of the sort's
+ *          temporary files, so the manifests and files of other sorts, interrupted or not,
+ *          are left alone. A sort that fails deletes its manifest and temporary files; only
+ *          a sort that is killed leaves them to be resumed.
+ *
+ * Input Parameters:
+ *          in: the input stream.
+ *          outName: name of the sorted output file.
+ *          options: memory budget, run method, # of threads, # of tapes, run coding,
+ *                   temporary directory and fan-in.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters: none.
+ * Return Value:
+ *          SortResult: the # of records, runs and merge passes.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+SortResult externalSort(istream& in, const string& outName, const SortOptions& options, const Order& order,
+                        const Reducer& reducer)
+{
+    TextReader<Record> inFile(in);
+    SortResult result;
+    result.inMemory = false;
+
+    // Only use as many sort threads as there are blocks of a useful size:
+    size_t workerNum = options.memBudget / sizeof(Record) / MIN_PARALLEL_BLOCK;
+    if (workerNum > options.threadNum)
+        workerNum = options.threadNum;
+
+    // Split the input file into sorted runs, one file per run or spread over the tapes:
+    uint32_t runFlags = RUN_SORTED;
+    if (options.deltaRuns && DeltaVarint<Record>::supported)
+        runFlags |= RUN_DELTA;
+    SortManifest manifest(options.tempDir, outName, options.tapeNum == 0);
+    try {
+        manifest.start();
+        RunDistributor<Record> runs(manifest, options.tapeNum, runFlags);
+        sortStats().beginPhase("run generation");
+        if (options.runMethod == REPLACEMENT_SELECTION)
+            replacementSelection(options.memBudget, result.recordNum, inFile, runs, order, reducer);
+        else if (workerNum > 1)
+            splitFilesParallel(options.memBudget, workerNum, result.recordNum, inFile, runs, order, reducer);
+        else
+            splitFiles(options.memBudget, result.recordNum, inFile, runs, order, reducer);
+        result.runNum = runs.runCount();
+        sortStats().addRecordsRead(result.recordNum);
+        sortStats().endPhase();
+
+        // Merge up to fanIn runs at a time, or merge the tapes, until everything is in the output file:
+        if (runs.usesTapes())
+        {
+            result.fanIn = options.tapeNum - 1;
+            result.passNum = polyphaseMerge(runs, options.memBudget, outName, order, reducer);
+        }
+        else
+        {
+            result.fanIn = (options.fanIn > 0) ? max(options.fanIn, size_t(2)) : chooseFanIn(options.memBudget);
+            manifest.runsDone(runs.fileNames(), result.recordNum, result.fanIn, runFlags);
+            result.passNum = mergeAllRuns<Record>(runs.fileNames(), result.fanIn, options.memBudget,
+                                                  options.threadNum, outName, runFlags, manifest, order, reducer);
+        }
+    }
+    catch (...) {
+        manifest.discard();                      // a failed sort leaves no temporary files
+        throw;
+    }
+    return result;
+}
+
+
+/*******************************************************************************************
+ * Function Name: keep / rethrow
+ * ------------------
+ * Purpose: To keep the exception being handled by a thread of a parallel stage if it is the
+ *          first, and to throw it on the calling thread once every thread is joined.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void FirstError::keep()
+{
+    lock_guard<mutex> guard(lock);
+    if (!error)
+        error = current_exception();
+    failed = true;
+}
+
+inline void FirstError::rethrow()
+{
+    if (failed)
+        rethrow_exception(error);
+}
+
+
+/*******************************************************************************************
+ * Function Name: openFileLimit
+ * ------------------
+ * Purpose: To find the number of files this process may keep open at once.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the open-file limit.
+ *******************************************************************************************/
+inline size_t openFileLimit()
+{
+#ifndef _WIN32
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        return static_cast<size_t>(limit.rlim_cur);
+#endif
+    return FOPEN_MAX > 256 ? FOPEN_MAX : 256;
+}
+
+
+/*******************************************************************************************
+ * Function Name: chooseFanIn
+ * ------------------
+ * Purpose: To choose how many runs are merged at once. Every run being merged needs
+ *          a read buffer of at least MIN_RUN_BUFFER bytes, plus one for the output,
+ *          and every run is an open file, so the fan-in is limited by both the memory
+ *          budget and the open-file limit.
+ *
+ * Input Parameters:
+ *          memBudget: memory budget in bytes.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the fan-in, at least 2.
+ *******************************************************************************************/
+inline size_t chooseFanIn(size_t memBudget)
+{
+    size_t byMemory = memBudget / MIN_RUN_BUFFER;
+    byMemory = (byMemory > 1) ? byMemory - 1 : 0;       // one buffer goes to the output file
+    size_t limit = openFileLimit();
+    size_t byFiles = (limit > RESERVED_FILES) ? limit - RESERVED_FILES : 0;
+
+    size_t fanIn = (byMemory < byFiles) ? byMemory : byFiles;
+    return (fanIn < 2) ? 2 : fanIn;
+}
+
+/*******************************************************************************************
+ * Function Name: parseByteSize
+ * ------------------
+ * Purpose: To read a byte count such as "4096", "64K", "512M" or "2G", as given
+ *          for a memory budget. A "B" may follow the suffix, as in "64KB".
+ *
+ * Input Parameters:
+ *          text: the byte count, with an optional K/M/G suffix.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the number of bytes, or 0 if the text is not a byte count.
+ *******************************************************************************************/
+inline size_t parseByteSize(const string& text)
+{
+    char* end = nullptr;
+    unsigned long long value = strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str())
+        return 0;
+
+    switch (*end)
+    {
+        case 'G': case 'g': value <<= 10;   // fall through
+        case 'M': case 'm': value <<= 10;   // fall through
+        case 'K': case 'k': value <<= 10; end++; break;
+        case '\0': break;
+        default: return 0;
+    }
+    if (*end == 'B' || *end == 'b')
+        end++;
+    return (*end == '\0') ? static_cast<size_t>(value) : 0;
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunDistributor
+ * ------------------
+ * Purpose: To set up the distributor. With tapes, the first level of the
+ *          distribution puts one run on every tape but the last one.
+ *
+ * Input Parameters:
+ *          manifest: names the run files and the tape files.
+ *          tapeNum: 0 for one file per run, else the # of tape files (at least 3).
+ *          flags: header flags of every run.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record>
+RunDistributor<Record>::RunDistributor(const SortManifest& manifest, size_t tapeNum, uint32_t flags)
+    : manifest(manifest), tapeNum(tapeNum), flags(flags), tape(0), perfect(tapeNum, 1), dummyRuns(tapeNum, 1), realRuns(tapeNum, 0)
+{
+    for (size_t i = 0; i < tapeNum; i++)
+        names.push_back(manifest.tapeName(i));
+    if (tapeNum > 0)
+        perfect[tapeNum - 1] = dummyRuns[tapeNum - 1] = 0;
+}
+
+
+/*******************************************************************************************
+ * Function Name: beginRun
+ * ------------------
+ * Purpose: To open a writer for the next run: a new run file, or the end of the current tape.
+ *
+ * Input Parameters:
+ *          bufferBytes: # of bytes buffered by the writer.
+ * Output parameters: none.
+ * Return Value:
+ *          RunWriter<Record>*: the writer, to be given back to endRun.
+ *******************************************************************************************/
+template <typename Record>
+RunWriter<Record>* RunDistributor<Record>::beginRun(size_t bufferBytes)
+{
+    if (tapeNum == 0)
+    {
+        names.push_back(manifest.runName(0, names.size()));
+        return new RunWriter<Record>(names.back(), bufferBytes, flags);
+    }
+    return new RunWriter<Record>(names[tape], bufferBytes, flags, realRuns[tape] > 0);
+}
+
+
+/*******************************************************************************************
+ * Function Name: endRun
+ * ------------------
+ * Purpose: To close and free the writer of a run. With tapes, one dummy run of the
+ *          current tape has become real, and the next tape is chosen so the
+ *          distribution stays perfect.
+ *
+ * Input Parameters:
+ *          run: the writer returned by beginRun.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record>
+void RunDistributor<Record>::endRun(RunWriter<Record>* run)
+{
+    try {
+        run->close();                             // a write error of the run is thrown here
+    }
+    catch (...) {
+        delete run;
+        throw;
+    }
+    delete run;
+    sortStats().addRuns(1);
+    if (tapeNum == 0)
+        return;
+
+    dummyRuns[tape]--;
+    realRuns[tape]++;
+    if (dummyRuns[tape] < dummyRuns[tape + 1])    // the next tape is further from perfect
+        tape++;
+    else if (dummyRuns[tape] == 0)                // this level is full: go up a level
+    {
+        size_t first = perfect[0];
+        for (size_t i = 0; i + 1 < tapeNum; i++)
+        {
+            dummyRuns[i] = first + perfect[i + 1] - perfect[i];
+            perfect[i] = first + perfect[i + 1];
+        }
+        tape = 0;
+    }
+    else
+        tape = 0;
+}
+
+
+/*******************************************************************************************
+ * Function Name: runCount
+ * ------------------
+ * Purpose: To count the runs written.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the # of runs written.
+ *******************************************************************************************/
+template <typename Record>
+size_t RunDistributor<Record>::runCount() const
+{
+    if (tapeNum == 0)
+        return names.size();
+    size_t count = 0;
+    for (size_t i = 0; i < tapeNum; i++)
+        count += realRuns[i];
+    return count;
+}
+
+
+/*******************************************************************************************
+ * Function Name: mergeAllRuns
+ * ------------------
+ * Purpose: To merge all runs, up to fanIn at a time, into one sorted output file.
+ *          Every pass replaces groups of fanIn runs by their merged run, until the
+ *          remaining runs can be merged straight into the text output file.
+ *          Large groups are merged by threadNum threads, each on its own key range.
+ *          Every merged group is recorded in the manifest before its run files are deleted,
+ *          so disk use stays near the input plus one group. A merge resumed from a loaded
+ *          manifest starts with the first group not merged yet. With a limit, only the first
+ *          limit records of the output are wanted, so every merged run is cut after as
+ *          many records, on one thread.
+ *
+ * Input Parameters:
+ *          runNames: names of the run files.
+ *          fanIn: max # of runs merged at once.
+ *          memBudget: memory budget in bytes, shared by the buffers of a merge.
+ *          threadNum: max # of merge threads.
+ *          outName: name of the final output file.
+ *          runFlags: header flags of the merged runs.
+ *          manifest: names the merged runs and records the merge.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ *          limit: max # of records to write, 0 for all.
+ * Output parameters: none.
+ * Return Value:
+ *          int: the # of merge passes made, with those before a resume.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+int mergeAllRuns(vector<string> runNames, size_t fanIn, size_t memBudget, size_t threadNum, const string& outName,
+                 uint32_t runFlags, SortManifest& manifest, const Order& order, const Reducer& reducer,
+                 uint64_t limit)
+{
+    int passNum = 0;
+    vector<string> mergedNames;
+    manifest.resumePoint(runNames, passNum, mergedNames);
+    while (runNames.size() > fanIn)
+    {
+        passNum++;
+        sortStats().beginPhase("merge pass " + to_string(passNum), fanIn);
+        for (size_t first = mergedNames.size() * fanIn; first < runNames.size(); first += fanIn)
+        {
+            size_t last = (first + fanIn < runNames.size()) ? first + fanIn : runNames.size();
+            mergedNames.push_back(manifest.runName(passNum, mergedNames.size()));
+            if (limit > 0 || !mergeRunFilesParallel<Record>(runNames, first, last, mergedNames.back(), false,
+                                                            memBudget, threadNum, order, reducer))
+            {
+                size_t bufferSize = memBudget / (last - first + 1);     // one buffer per run plus one for the output
+                RunWriter<Record> outRun(mergedNames.back(), bufferSize, runFlags);
+                mergeRunFiles<Record>(runNames, first, last, outRun, bufferSize, order, reducer, limit);
+            }
+            manifest.groupMerged(passNum, mergedNames.size() - 1, mergedNames.back());
+            for (size_t i = first; i < last; i++)
+                remove(runNames[i].c_str());
+            sortStats().addRuns(1);
+        }
+        runNames.swap(mergedNames);
+        mergedNames.clear();
+        sortStats().endPhase();
+    }
+
+    // final pass
+    sortStats().beginPhase("final merge", runNames.size());
+    if (limit > 0 || !mergeRunFilesParallel<Record>(runNames, 0, runNames.size(), outName, true, memBudget,
+                                                    threadNum, order, reducer))
+    {
+        TextWriter<Record> outFile(outName);
+        mergeRunFiles<Record>(runNames, 0, runNames.size(), outFile, memBudget / (runNames.size() + 1), order, reducer,
+                              limit);
+    }
+    for (size_t i = 0; i < runNames.size(); i++)
+        remove(runNames[i].c_str());
+    manifest.finish();
+    sortStats().endPhase();
+    return passNum + 1;
+}
+
+
+/*******************************************************************************************
+ * Function Name: polyphaseMerge
+ * ------------------
+ * Purpose: To merge the runs on the tapes of a distributor by polyphase merging.
+ *          Every phase merges one run from each non-empty input tape onto the empty tape
+ *          until one input tape runs empty, which then becomes the output tape of the next
+ *          phase. A merge of dummy runs only gives a dummy run on the output tape. The phase
+ *          in which every input tape holds a single run merges straight into the text output.
+ *
+ * Input Parameters:
+ *          runs: the distributor that wrote the runs onto the tapes.
+ *          memBudget: memory budget in bytes, shared by one buffer per tape.
+ *          outName: name of the final output file.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters: none.
+ * Return Value:
+ *          int: the # of merge phases made.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+int polyphaseMerge(RunDistributor<Record>& runs, size_t memBudget, const string& outName, const Order& order,
+                   const Reducer& reducer)
+{
+    const vector<string>& tapes = runs.fileNames();
+    size_t tapeNum = tapes.size();
+    vector<size_t>& dummyRuns = runs.dummyRuns;
+    vector<size_t>& realRuns = runs.realRuns;
+    vector<uint64_t> nextRun(tapeNum, 0);      // byte position of the next real run on every tape
+    size_t bufferSize = memBudget / tapeNum;
+    size_t outTape = tapeNum - 1;
+    int phaseNum = 0;
+
+    while (true)
+    {
+        phaseNum++;
+        size_t mergeNum = 0, emptied = outTape;  // the input tape with the fewest runs empties first
+        bool finalPhase = true;
+        for (size_t t = 0; t < tapeNum; t++)
+        {
+            size_t count = dummyRuns[t] + realRuns[t];
+            if (t == outTape || count == 0)
+                continue;
+            finalPhase = finalPhase && count == 1;
+            if (emptied == outTape || count < mergeNum)
+            {
+                mergeNum = count;
+                emptied = t;
+            }
+        }
+        if (emptied == outTape)                  // no runs at all
+            mergeNum = 1;
+        sortStats().beginPhase(finalPhase ? string("final merge") : "polyphase phase " + to_string(phaseNum),
+                               tapeNum - 1);
+
+        bool appendOut = false;                  // the output tape starts over in every phase
+        for (size_t m = 0; m < mergeNum; m++)
+        {
+            vector<RunReader<Record>*> inRuns;   // one run, or a dummy run, from every input tape
+            for (size_t t = 0; t < tapeNum; t++)
+            {
+                if (t == outTape || dummyRuns[t] + realRuns[t] == 0)
+                    continue;
+                if (dummyRuns[t] > 0)
+                    dummyRuns[t]--;
+                else
+                {
+                    inRuns.push_back(new RunReader<Record>(tapes[t], bufferSize, nextRun[t]));
+                    nextRun[t] = inRuns.back()->endPos();
+                    realRuns[t]--;
+                }
+            }
+
+            if (finalPhase)
+            {
+                TextWriter<Record> outFile(outName);
+                mergeRuns(inRuns, outFile, order, reducer);
+            }
+            else if (inRuns.empty())
+                dummyRuns[outTape]++;
+            else
+            {
+                RunWriter<Record> outRun(tapes[outTape], bufferSize, runs.runFlags(), appendOut);
+                mergeRuns(inRuns, outRun, order, reducer);
+                realRuns[outTape]++;
+                appendOut = true;
+                sortStats().addRuns(1);
+            }
+            for (size_t i = 0; i < inRuns.size(); i++)
+                delete inRuns[i];
+        }
+        sortStats().endPhase();
+        if (finalPhase)
+            break;
+
+        nextRun[outTape] = 0;                    // the new runs are read from the start of the tape
+        outTape = emptied;
+    }
+
+    for (size_t t = 0; t < tapeNum; t++)
+        remove(tapes[t].c_str());
+    return phaseNum;
+}
+
+
+/*******************************************************************************************
+ * Function Name: mergeRuns
+ * ------------------
+ * Purpose: To merge sorted runs with a loser tree into one output. Records with equal keys
+ *          meet in the merge, so the reducer combines them here. A merge with a limit stops
+ *          as soon as it has written that many records.
+ *
+ * Input Parameters:
+ *          inRuns: readers of the runs.
+ *          out: RunWriter or TextWriter that receives the merged records; it is closed at the end.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ *          limit: max # of records to write, 0 for all.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer, typename Writer>
+void mergeRuns(vector<RunReader<Record>*>& inRuns, Writer& out, const Order& order, const Reducer& reducer,
+               uint64_t limit)
+{
+    LoserTree<Record, Order> tree(inRuns.size(), order);
+    Record record;
+    for (size_t i = 0; i < inRuns.size(); i++)   // read the first record of every run
+    {
+        if (inRuns[i]->next(record))
+            tree.setLeaf(i, record);
+        else
+            tree.setExhausted(i);
+    }
+    tree.build();
+
+    Reduction<Record, Order, Reducer> reduction(order, reducer, limit);
+    while (!tree.empty() && !reduction.full())   // output the smallest record, then replace it by the next one of its run
+    {
+        reduction.write(out, tree.topKey());
+        if (inRuns[tree.top()]->next(record))
+            tree.replaceTop(record);
+        else
+            tree.exhaustTop();
+    }
+    reduction.flush(out);
+    out.close();
+}
+
+
+/*******************************************************************************************
+ * Function Name: mergeRunFiles
+ * ------------------
+ * Purpose: To merge a group of run files into one output. The run files are left to the caller.
+ *
+ * Input Parameters:
+ *          runNames: names of the run files.
+ *          first: index of the first run of the group.
+ *          last: index one past the last run of the group.
+ *          out: RunWriter or TextWriter that receives the merged records; it is closed at the end.
+ *          bufferSize: bytes of read buffer for every run.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ *          limit: max # of records to write, 0 for all.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer, typename Writer>
+void mergeRunFiles(const vector<string>& runNames, size_t first, size_t last, Writer& out, size_t bufferSize,
+                   const Order& order, const Reducer& reducer, uint64_t limit)
+{
+    vector<RunReader<Record>*> inRuns(last - first);
+    for (size_t i = 0; i < inRuns.size(); i++)
+        inRuns[i] = new RunReader<Record>(runNames[first + i], bufferSize);
+
+    mergeRuns(inRuns, out, order, reducer, limit);
+
+    for (size_t i = 0; i < inRuns.size(); i++)
+        delete inRuns[i];
+}
+
+
+/*******************************************************************************************
+ * Function Name: mergeRunFilesParallel
+ * ------------------
+ * Purpose: To merge a group of run files on several threads. The run files are left to the caller.
+ *          Splitter keys are sampled from the runs and every run is cut at the splitters by
+ *          binary search, so each thread merges one disjoint key range of all runs. The size
+ *          of every range is known in advance, so binary output is written in place at the
+ *          range's offset of one run file. Text output is handed over in chunks through one
+ *          bounded queue per range, and the calling thread writes the ranges to the output
+ *          file in key order while the later ranges are still being merged.
+ *          Runs of variable-size records and delta coded runs cannot be cut by binary
+ *          search, so they are always left to mergeRunFiles; so is a merge into a run file
+ *          that combines records, whose range sizes are not known in advance.
+ *
+ * Input Parameters:
+ *          runNames: names of the run files.
+ *          first: index of the first run of the group.
+ *          last: index one past the last run of the group.
+ *          outName: name of the output file.
+ *          textOutput: whether the output is the final text file instead of a run file.
+ *          memBudget: memory budget in bytes, shared by all buffers of all threads.
+ *          threadNum: max # of merge threads.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: false, without merging, if the group is too small for more than one thread.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+bool mergeRunFilesParallel(const vector<string>& runNames, size_t first, size_t last, const string& outName,
+                           bool textOutput, size_t memBudget, size_t threadNum,
+                           const Order& order, const Reducer& reducer)
+{
+    const size_t width = RecordCodec<Record>::width;
+    if (width == 0 || (ReducerTraits<Reducer>::reduces && !textOutput))
+        return false;
+
+    size_t k = last - first;
+    vector<ifstream> inFiles(k);
+    vector<uint64_t> counts(k);
+    uint64_t total = 0;
+    bool delta = false;
+    for (size_t i = 0; i < k; i++)
+    {
+        inFiles[i].open(runNames[first + i], ios::binary);
+        RunHeader header = readRunHeader(inFiles[i], runNames[first + i], width);
+        counts[i] = header.recordCount;
+        total += counts[i];
+        delta = delta || (header.flags & RUN_DELTA) != 0;
+    }
+
+    size_t partNum = static_cast<size_t>(total / MIN_PARALLEL_BLOCK);
+    if (partNum > threadNum)
+        partNum = threadNum;
+    if (partNum < 2 || delta)
+        return false;
+
+    // Sample every run in proportion to its size and take evenly spaced splitters:
+    vector<Record> samples;
+    for (size_t i = 0; i < k; i++)
+    {
+        uint64_t sampleNum = SAMPLES_PER_PART * partNum * counts[i] / total + 1;
+        for (uint64_t j = 0; j < sampleNum && counts[i] > 0; j++)
+            samples.push_back(readRecordAt<Record>(inFiles[i], (2 * j + 1) * counts[i] / (2 * sampleNum)));
+    }
+    sort(samples.begin(), samples.end(), order);
+    vector<Record> splitters;
+    for (size_t p = 1; p < partNum; p++)
+        splitters.push_back(samples[p * samples.size() / partNum]);
+
+    // Cut every run at the splitters; part p takes the records in [splitter p-1, splitter p):
+    vector<vector<uint64_t> > cuts(k, vector<uint64_t>(partNum + 1));
+    vector<uint64_t> offsets(partNum + 1, 0);
+    for (size_t i = 0; i < k; i++)
+    {
+        cuts[i][0] = 0;
+        for (size_t p = 1; p < partNum; p++)
+            cuts[i][p] = lowerBoundInRun(inFiles[i], counts[i], splitters[p - 1], order);
+        cuts[i][partNum] = counts[i];
+        inFiles[i].close();
+        for (size_t p = 0; p < partNum; p++)
+            offsets[p + 1] += cuts[i][p + 1] - cuts[i][p];
+    }
+    for (size_t p = 0; p < partNum; p++)
+        offsets[p + 1] += offsets[p];
+
+    // Merge every key range on its own thread:
+    ofstream outFile;
+    ostream* out = nullptr;
+    if (textOutput)
+        out = &openTextOutput(outName, outFile);
+    else
+        createRunFile(outName, width, total);
+    size_t bufferSize = memBudget / partNum / (k + 1);
+    deque<BoundedQueue<string> > chunks;             // the text of every range, a chunk at a time
+    for (size_t p = 0; p < partNum && textOutput; p++)
+        chunks.emplace_back(bufferSize / TEXT_BUFFER_BYTES);
+    FirstError errors;
+    auto fail = [&]() {                              // keep the exception and stop every range
+        errors.keep();
+        for (size_t p = 0; p < chunks.size(); p++)
+            chunks[p].close();
+    };
+    vector<thread> workers;
+    for (size_t p = 0; p < partNum; p++)
+        workers.emplace_back([&, p]() {
+            vector<RunReader<Record>*> inRuns;
+            try {
+                for (size_t i = 0; i < k; i++)
+                    inRuns.push_back(new RunReader<Record>(runNames[first + i], bufferSize, cuts[i][p],
+                                                           cuts[i][p + 1]));
+                if (textOutput)
+                {
+                    TextChunks<Record> outText(chunks[p], TEXT_BUFFER_BYTES);
+                    mergeRuns(inRuns, outText, order, reducer);
+                }
+                else
+                {
+                    RunWriter<Record> outRun(outName, bufferSize, offsets[p]);
+                    mergeRuns(inRuns, outRun, order, reducer);
+                }
+            }
+            catch (...) {
+                fail();
+            }
+            for (size_t i = 0; i < inRuns.size(); i++)
+                delete inRuns[i];
+        });
+
+    // Write the text of the ranges in key order as it is made:
+    try {
+        string chunk;
+        for (size_t p = 0; p < chunks.size() && !errors.any(); p++)
+            while (chunks[p].pop(chunk) && !errors.any())
+            {
+                IoTimer timer;
+                if (!out->write(chunk.data(), chunk.size()))
+                    throw runtime_error("Unable to write output file \"" + outName + "\"");
+                sortStats().addBytesWritten(chunk.size());
+            }
+        if (textOutput && !errors.any() && !out->flush())
+            throw runtime_error("Unable to write output file \"" + outName + "\"");
+    }
+    catch (...) {
+        fail();
+    }
+
+    for (size_t p = 0; p < partNum; p++)
+        workers[p].join();
+    errors.rethrow();
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: readBlockFromFile
+ * ------------------
+ * Purpose: To read the records that fit in a memory budget from an input file.
+ *
+ * Input Parameters:
+ *          in: reader of the input text.
+ *          block: vector that receives the block; what it held before is dropped.
+ *          memBudget: memory budget of the block in bytes, at least one record is read.
+ * Output parameters:
+ *          block: the records read.
+ * Return Value:
+ *          bool: false if the end of the file was reached before the budget was used up.
+ *******************************************************************************************/
+template <typename Record>
+bool readBlockFromFile(TextReader<Record>& in, vector<Record>& block, size_t memBudget)
+{
+    block.clear();
+    if (RecordCodec<Record>::width > 0)
+        block.reserve(memBudget / sizeof(Record) + 1);
+
+    size_t used = 0;
+    Record record;
+    while (used < memBudget && in.read(record))   // read 1 block from file
+    {
+        used += RecordCodec<Record>::memory(record);
+        block.push_back(record);
+    }
+    return used >= memBudget;
+}
+
+
+/*******************************************************************************************
+ * Function Name: permuteKeys
+ * ------------------
+ * Purpose: To decide whether records are sorted by permutation of their keys: when
+ *          their keys are smaller than they are, and they are large or variable-size.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: true to sort (key, position) pairs instead of the records.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+bool permuteKeys()
+{
+    return sizeof(typename Order::Key) < sizeof(Record)
+        && (RecordCodec<Record>::width == 0 || sizeof(Record) > PERMUTE_RECORD_BYTES);
+}
+
+
+/*******************************************************************************************
+ * Function Name: sortBlock
+ * ------------------
+ * Purpose: To sort a block of records, either in place or by permutation of their keys.
+ *          Integer keys are radix sorted, other keys are merge sorted; both sorts are
+ *          stable and use the scratch block rather than memory of their own.
+ *
+ * Input Parameters:
+ *          block: the block read from the input file.
+ *          scratch: a block of the same sort thread, whose vectors serve as scratch space.
+ *          order: the order of the records.
+ * Output parameters:
+ *          block: the sorted records, or the sorted (key, position) pairs.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+void sortBlock(SortBlock<Record, Order>& block, SortBlock<Record, Order>& scratch, const Order& order)
+{
+    typedef typename Order::Key Key;                                    // for convenience
+    typedef pair<Key, uint32_t> KeyPos;
+    typedef RadixKey<Key, typename Order::KeyCompare> Radix;
+    bool radix = Radix::usable && block.records.size() >= MIN_RADIX_RECORDS;
+
+    if (!permuteKeys<Record, Order>() || block.records.size() > UINT32_MAX)
+    {
+        block.keys.clear();
+        if (radix)
+            radixSort(block.records.data(), block.records.size(), scratch.records,
+                      [&order](const Record& record) { return Radix::bits(order.key(record)); });
+        else
+            stableSortBlock(block.records.data(), block.records.size(), scratch.records, order);
+        return;
+    }
+
+    block.keys.resize(block.records.size());
+    for (size_t i = 0; i < block.records.size(); i++)
+        block.keys[i] = KeyPos(order.key(block.records[i]), static_cast<uint32_t>(i));
+    if (radix)
+        radixSort(block.keys.data(), block.keys.size(), scratch.keys,
+                  [](const KeyPos& k) { return Radix::bits(k.first); });
+    else
+        stableSortBlock(block.keys.data(), block.keys.size(), scratch.keys,
+                        [&order](const KeyPos& a, const KeyPos& b) { return order.keyLess(a.first, b.first); });
+}
+
+
+/*******************************************************************************************
+ * Function Name: storeToFile
+ * ------------------
+ * Purpose: To store a sorted block as the next run, combining records with equal keys.
+ *
+ * Input Parameters:
+ *          block: the block sorted by sortBlock.
+ *          runs: the distributor that places the run.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+void storeToFile(const SortBlock<Record, Order>& block, RunDistributor<Record>& runs, const Order& order,
+                 const Reducer& reducer)
+{
+    RunWriter<Record>* outRun = runs.beginRun(MIN_RUN_BUFFER);
+    Reduction<Record, Order, Reducer> reduction(order, reducer);
+    if (block.keys.empty() && !ReducerTraits<Reducer>::reduces)
+        outRun->write(block.records.data(), block.records.size());     // store 1 block with one write
+    else if (block.keys.empty())
+        for (size_t i = 0; i < block.records.size(); i++)
+            reduction.write(*outRun, block.records[i]);
+    else
+        for (size_t i = 0; i < block.keys.size(); i++)
+            reduction.write(*outRun, block.records[block.keys[i].second]);
+    reduction.flush(*outRun);
+    runs.endRun(outRun);
+}
+
+
+/*******************************************************************************************
+ * Function Name: splitFiles
+ * ------------------
+ * Purpose: To split the input file into sorted runs of the records that fit in the
+ *          memory budget. The input length is discovered while streaming, so the last
+ *          run may be shorter.
+ *
+ * Input Parameters:
+ *          memBudget: memory budget in bytes.
+ *          inFile: reader of the input text.
+ *          runs: the distributor that places the runs.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters:
+ *          recordNum: the total # of records read from the input file.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+void splitFiles(size_t memBudget, uint64_t& recordNum, TextReader<Record>& inFile, RunDistributor<Record>& runs,
+                const Order& order, const Reducer& reducer)
+{
+    recordNum = 0;
+
+    // Read the input file block by block, sort it, and store it as a run:
+    SortBlock<Record, Order> block, scratch;
+    while (true)
+    {
+        bool more = readBlockFromFile(inFile, block.records, memBudget);   // Read 1 block from input file
+        if (!block.records.empty())
+        {
+            sortBlock(block, scratch, order);                               // sort it
+            storeToFile(block, runs, order, reducer);                       // store the run
+            recordNum += block.records.size();
+        }
+        if (!more)                // a short block means the end of the input file
+            break;
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: splitFilesParallel
+ * ------------------
+ * Purpose: To split the input file into sorted runs with a three-stage pipeline:
+ *          the calling thread reads blocks, workerNum threads sort them, and a writer
+ *          thread stores them as run files. The stages are connected by bounded queues,
+ *          and a fixed pool of workerNum + 2 blocks shares the memory budget, so the
+ *          next blocks are read and earlier runs are written while every worker is
+ *          sorting a block. If a stage throws, as on a bad input token or a run file that
+ *          cannot be written, every queue is closed so no stage waits for it, and the
+ *          exception is thrown here once all threads are joined.
+ *
+ * Input Parameters:
+ *          memBudget: memory budget in bytes.
+ *          workerNum: the # of sort threads.
+ *          inFile: reader of the input text.
+ *          runs: the distributor that places the runs.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters:
+ *          recordNum: the total # of records read from the input file.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+void splitFilesParallel(size_t memBudget, size_t workerNum, uint64_t& recordNum, TextReader<Record>& inFile,
+                        RunDistributor<Record>& runs, const Order& order, const Reducer& reducer)
+{
+    typedef SortBlock<Record, Order> Block;      // for convenience
+
+    size_t bufferNum = workerNum + 2;            // one being read, one being written, one per worker
+    size_t bufferSize = memBudget / bufferNum;
+    vector<Block> pool(bufferNum);
+    BoundedQueue<Block*> freeBlocks(bufferNum), readBlocks(bufferNum), sortedBlocks(bufferNum);
+    for (size_t i = 0; i < bufferNum; i++)
+        freeBlocks.push(&pool[i]);
+
+    FirstError errors;
+    auto fail = [&]() {                          // keep the exception and stop every stage
+        errors.keep();
+        freeBlocks.close();
+        readBlocks.close();
+        sortedBlocks.close();
+    };
+
+    atomic<size_t> activeWorkers(workerNum);
+    vector<thread> workers;
+    for (size_t i = 0; i < workerNum; i++)       // sort stage
+        workers.emplace_back([&]() {
+            try {
+                Block* block;
+                Block scratch;                   // scratch space of this worker's sorts
+                while (!errors.any() && readBlocks.pop(block))
+                {
+                    sortBlock(*block, scratch, order);
+                    sortedBlocks.push(block);
+                }
+            }
+            catch (...) {
+                fail();
+            }
+            if (--activeWorkers == 0)            // the last worker out closes the next stage
+                sortedBlocks.close();
+        });
+
+    thread writer([&]() {                        // write stage
+        try {
+            Block* block;
+            while (!errors.any() && sortedBlocks.pop(block))
+            {
+                storeToFile(*block, runs, order, reducer);
+                freeBlocks.push(block);
+            }
+        }
+        catch (...) {
+            fail();
+        }
+    });
+
+    recordNum = 0;                               // read stage
+    try {
+        Block* block;
+        while (!errors.any() && freeBlocks.pop(block))
+        {
+            bool more = readBlockFromFile(inFile, block->records, bufferSize);
+            if (block->records.empty())
+                break;
+            readBlocks.push(block);
+            recordNum += block->records.size();
+            if (!more)                           // a short block means the end of the input file
+                break;
+        }
+    }
+    catch (...) {
+        fail();
+    }
+    readBlocks.close();
+
+    for (size_t i = 0; i < workerNum; i++)
+        workers[i].join();
+    writer.join();
+    errors.rethrow();
+}
+
+
+/*
+ * Type: SlotIndex
+ * ---------------
+ * A heap entry of replacement selection for records sorted by
+ * permutation: the position of the record in the slot array.
+ */
+struct SlotIndex
+{
+    uint32_t index;
+};
+
+/* Return the record of a heap entry, which is either the record itself or its slot */
+template <typename Record>
+const Record& itemRecord(const Record& item, const vector<Record>&) { return item; }
+
+template <typename Record>
+const Record& itemRecord(const SlotIndex& item, const vector<Record>& slots) { return slots[item.index]; }
+
+/* Read the next input record into a heap entry, or into its slot */
+template <typename Record>
+bool readItem(TextReader<Record>& in, Record& item, vector<Record>&) { return in.read(item); }
+
+template <typename Record>
+bool readItem(TextReader<Record>& in, SlotIndex& item, vector<Record>& slots) { return in.read(slots[item.index]); }
+
+
+/*******************************************************************************************
+ * Function Name: replacementSelection
+ * ------------------
+ * Purpose: To run replacement selection over a heap of records, or of slot positions.
+ *
+ * Input Parameters:
+ *          heap: the first records read, or the slot positions of the first records.
+ *          slots: the first records read when the heap holds slot positions.
+ *          inFile: reader of the input text.
+ *          runs: the distributor that places the runs.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters:
+ *          recordNum: the total # of records read from the input file.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Item, typename Order, typename Reducer>
+void replacementSelection(vector<Item>& heap, vector<Record>& slots, uint64_t& recordNum, TextReader<Record>& inFile,
+                          RunDistributor<Record>& runs, const Order& order, const Reducer& reducer)
+{
+    auto after = [&](const Item& a, const Item& b) {      // makes the STL max-heap a min-heap
+        return order(itemRecord(b, slots), itemRecord(a, slots));
+    };
+    size_t n = heap.size();  // # of records in the array
+    size_t current = n;      // # of records in the heap of the current run
+    recordNum = n;
+
+    RunWriter<Record>* outRun = nullptr;
+    Reduction<Record, Order, Reducer> reduction(order, reducer);
+    while (n > 0)
+    {
+        if (current == 0 || outRun == nullptr)  // start a new run with all records left
+        {
+            current = n;
+            make_heap(heap.begin(), heap.begin() + current, after);
+            if (outRun != nullptr)
+            {
+                reduction.flush(*outRun);
+                runs.endRun(outRun);
+            }
+            outRun = runs.beginRun(MIN_RUN_BUFFER);
+        }
+
+        const Record& smallest = itemRecord(heap[0], slots);   // output the smallest record of the current run
+        reduction.write(*outRun, smallest);
+        typename Order::Key last = order.key(smallest);
+        pop_heap(heap.begin(), heap.begin() + current, after);
+
+        if (readItem(inFile, heap[current - 1], slots))       // the next record takes its place
+        {
+            recordNum++;
+            if (!order.keyLess(order.key(itemRecord(heap[current - 1], slots)), last))
+                push_heap(heap.begin(), heap.begin() + current, after);   // still fits in the current run
+            else
+                current--;                                                // must wait for the next run
+        }
+        else                                    // no more input, fill the hole with the last record
+        {
+            current--;
+            heap[current] = heap[n - 1];
+            n--;
+        }
+    }
+    if (outRun != nullptr)
+    {
+        reduction.flush(*outRun);
+        runs.endRun(outRun);
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: replacementSelection
+ * ------------------
+ * Purpose: To split the input file into sorted runs by replacement selection.
+ *          The heap holds the records for the current run at the front and the records
+ *          that are too small for the current run at the back. Every record written is
+ *          replaced by the next input record; when the current run is empty the back
+ *          becomes the heap of the next run. Runs average twice the heap size on random
+ *          input, and sorted input gives a single run. Records sorted by permutation stay
+ *          in their slots, and only their slot positions move through the heap.
+ *
+ * Input Parameters:
+ *          memBudget: memory budget in bytes.
+ *          inFile: reader of the input text.
+ *          runs: the distributor that places the runs.
+ *          order: the order of the records.
+ *          reducer: combines records with equal keys, or KeepAll.
+ * Output parameters:
+ *          recordNum: the total # of records read from the input file.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Record, typename Order, typename Reducer>
+void replacementSelection(size_t memBudget, uint64_t& recordNum, TextReader<Record>& inFile,
+                          RunDistributor<Record>& runs, const Order& order, const Reducer& reducer)
+{
+    vector<Record> slots;
+    readBlockFromFile(inFile, slots, memBudget);
+    if (permuteKeys<Record, Order>() && slots.size() <= UINT32_MAX)
+    {
+        vector<SlotIndex> heap(slots.size());
+        for (size_t i = 0; i < heap.size(); i++)
+            heap[i].index = static_cast<uint32_t>(i);
+        replacementSelection(heap, slots, recordNum, inFile, runs, order, reducer);
+    }
+    else
+    {
+        vector<Record> none;
+        replacementSelection(slots, none, recordNum, inFile, runs, order, reducer);
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: stableSortBlock
+ * ------------------
+ * Purpose: To sort an array by the mergesort of sort_algorithms.t, which merges back and
+ *          forth between the array and one scratch array. Records that are equal keep their
+ *          order. The scratch array is kept in a vector, so a caller that sorts many arrays
+ *          allocates it only once. An array too large for the int sizes of that mergesort
+ *          is left to stable_sort.
+ *
+ * Input Parameters:
+ *          arrayptr: the array.
+ *          arraySize: # of records in the array.
+ *          scratch: vector that holds the scratch array; what it held before is dropped.
+ *          less: the "less than" order of the records.
+ * Output parameters:
+ *          arrayptr: the sorted array.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename Less>
+void stableSortBlock(T* arrayptr, size_t arraySize, vector<T>& scratch, const Less& less)
+{
+    if (arraySize > static_cast<size_t>(INT_MAX))
+    {
+        stable_sort(arrayptr, arrayptr + arraySize, less);
+        return;
+    }
+    scratch.resize(arraySize);
+    msSort(arrayptr, static_cast<int>(arraySize), scratch.data(), less);
+}
+
+
+/*******************************************************************************************
+ * Function Name: radixSort
+ * ------------------
+ * Purpose: To sort an array by LSD radix sort on the unsigned rank of every record's key.
+ *          One pass counts every byte of every rank into a histogram per byte position;
+ *          then every byte position, from the lowest, is a stable counting sort pass that
+ *          moves the records between the array and the scratch vector. A byte position in
+ *          which all records agree is skipped, so small or clustered keys take fewer passes.
+ *          Records that are equal keep their order.
+ *
+ * Input Parameters:
+ *          arrayptr: the array.
+ *          arraySize: # of records in the array.
+ *          scratch: vector used as the second array; what it held before is dropped.
+ *          bitsOf: maps a record to the unsigned integer rank of its key.
+ * Output parameters:
+ *          arrayptr: the sorted array.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename BitsOf>
+void radixSort(T* arrayptr, size_t arraySize, vector<T>& scratch, const BitsOf& bitsOf)
+{
+    typedef decltype(bitsOf(*arrayptr)) Bits;    // for convenience
+    const size_t byteNum = sizeof(Bits);
+
+    if (arraySize < 2)
+        return;
+
+    // Count the bytes of every position in one pass:
+    vector<size_t> counts(byteNum * 256, 0);
+    for (size_t i = 0; i < arraySize; i++)
+    {
+        Bits rank = bitsOf(arrayptr[i]);
+        for (size_t b = 0; b < byteNum; b++)
+            counts[b * 256 + ((rank >> (8 * b)) & 0xFF)]++;
+    }
+
+    scratch.resize(arraySize);
+    T* source = arrayptr;
+    T* dest = scratch.data();
+    Bits firstRank = bitsOf(arrayptr[0]);
+    for (size_t b = 0; b < byteNum; b++)
+    {
+        size_t* count = &counts[b * 256];
+        if (count[(firstRank >> (8 * b)) & 0xFF] == arraySize)   // every record has this byte
+            continue;
+
+        size_t offset = 0;                       // turn the counts into first positions
+        for (size_t d = 0; d < 256; d++)
+        {
+            size_t n = count[d];
+            count[d] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < arraySize; i++)
+            dest[count[(bitsOf(source[i]) >> (8 * b)) & 0xFF]++] = move(source[i]);
+        std::swap(source, dest);
+    }
+
+    if (source != arrayptr)                      // an odd # of passes left the records in scratch
+        move(source, source + arraySize, arrayptr);
+}
+
+#endif //EXTSORT_T
@@ -0,0 +1,181 @@
+// Jian Zhong
+// CS232 Lab1
+// 10/17/2026
+// extSortTest.cpp
+//
+// Tests of the external sort: a sort whose output cannot be written, such as one to
+// /dev/full, must fail on every path of the sort (in memory, k-way merge on one or more
+// threads, polyphase merge) rather than report a short output file as sorted, and a
+// sort that fails must leave none of its temporary files behind. A selection by key
+// bounds beyond the keys of the records must clamp the bounds rather than wrap them.
+//
+//     g++ -std=c++17 -O2 -pthread -o extSortTest extSortTest.cpp
+//
+// The tests write their input and temporary files in the directory extSortTest.tmp,
+// which they remove again.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <filesystem>
+#include <stdexcept>
+#include <climits>
+#include "extSort.h"
+#include "extSelect.h"
+
+using namespace std;
+
+const char* const TEST_DIR = "extSortTest.tmp";
+const char* const FULL_DEVICE = "/dev/full";
+const int INPUT_RECORDS = 200000;   // ~1.3M of text, many runs at a 64K budget
+
+// Function Prototypes:
+string makeInput(const string& fileName, int recordNum);
+SortOptions testOptions(size_t memBudget);
+int testWriteErrors(const string& inName);
+size_t countTempFiles();
+int testKeyBounds();
+vector<int> selectInts(const Selection<long long>& range);
+bool check(bool passed, const string& what);
+
+int checkNum = 0;       // # of checks made
+
+// Main Function:
+int main() {
+    filesystem::remove_all(TEST_DIR);
+    filesystem::create_directory(TEST_DIR);
+    int failed = 0;
+    try {
+        string inName = makeInput(string(TEST_DIR) + "/input.txt", INPUT_RECORDS);
+        failed += testWriteErrors(inName);
+        failed += testKeyBounds();
+    }
+    catch (const runtime_error& error) {
+        failed += !check(false, error.what());
+    }
+    filesystem::remove_all(TEST_DIR);
+
+    cout << checkNum - failed << " of " << checkNum << " checks passed" << endl;
+    return (failed == 0) ? 0 : 1;
+}  /* end of main */
+
+
+/// Write a text file of random integers, one per line.
+/// @param fileName name of the file
+/// @param recordNum # of integers
+/// @return the name of the file
+string makeInput(const string& fileName, int recordNum)
+{
+    ofstream outFile(fileName);
+    mt19937 random(recordNum);
+    for (int i = 0; i < recordNum; i++)
+        outFile << static_cast<int>(random() % 2000000) - 1000000 << '\n';
+    outFile.close();
+    if (!outFile)
+        throw runtime_error("Unable to create input file \"" + fileName + "\"");
+    return fileName;
+}
+
+/// Make the options of a test sort: one thread, temporary files in the test directory.
+/// @param memBudget memory budget in bytes
+/// @return the options
+SortOptions testOptions(size_t memBudget)
+{
+    SortOptions options = { memBudget, REPLACEMENT_SELECTION, 1, 0, false, true, TEST_DIR, false, 0 };
+    return options;
+}
+
+/// Check that a sort to a full device throws on every path of the sort.
+/// @param inName name of the input file
+/// @return the # of failed checks
+int testWriteErrors(const string& inName)
+{
+    const string paths[] = { "in-memory", "k-way", "parallel k-way", "polyphase" };
+
+    int failed = 0;
+    for (const string& path : paths)
+    {
+        SortOptions options = testOptions((path == "in-memory") ? 64 << 20 : 64 << 10);
+        if (path == "parallel k-way")
+            options.threadNum = 4;
+        if (path == "polyphase")
+            options.tapeNum = 3;
+
+        bool thrown = false;
+        try {
+            sortFile<int, SortOrder<int> >(inName, FULL_DEVICE, options);
+        }
+        catch (const runtime_error& error) {
+            thrown = string(error.what()).find(FULL_DEVICE) != string::npos;
+        }
+        failed += !check(thrown, "a " + path + " sort to " + FULL_DEVICE + " throws a write error");
+        failed += !check(countTempFiles() == 0, "a " + path + " sort that failed leaves no temporary files");
+    }
+    return failed;
+}
+
+/// Count the temporary files of sorts in the test directory.
+/// @return the # of files whose names start with "sort"
+size_t countTempFiles()
+{
+    size_t count = 0;
+    for (const filesystem::directory_entry& entry : filesystem::directory_iterator(TEST_DIR))
+        count += entry.path().filename().string().compare(0, 4, "sort") == 0;
+    return count;
+}
+
+/// Check that key bounds beyond the keys of int records are clamped: a low bound above
+/// every int or a high bound below every int selects nothing, and a bound beyond the
+/// other end does not limit the range.
+/// @return the # of failed checks
+int testKeyBounds()
+{
+    const long long beyond = 4294967297LL;       // 2^32 + 1, which an int cast would make 1
+    Selection<long long> aboveAll = { 0, true, beyond, false, 0 };
+    Selection<long long> belowAll = { 0, false, 0, true, -beyond };
+    Selection<long long> upToFive = { 0, true, -beyond, true, 5 };
+    Selection<long long> fromOne = { 0, true, 1, true, beyond };
+
+    int failed = 0;
+    failed += !check(selectInts(aboveAll).empty(), "a low bound above every int selects nothing");
+    failed += !check(selectInts(belowAll).empty(), "a high bound below every int selects nothing");
+    failed += !check(selectInts(upToFive) == vector<int>({ INT_MIN, -3, 1, 5 }),
+                     "a low bound below every int does not limit the range");
+    failed += !check(selectInts(fromOne) == vector<int>({ 1, 5, 9, INT_MAX }),
+                     "a high bound above every int does not limit the range");
+    return failed;
+}
+
+/// Select from a small file of ints, with the smallest and the largest int among them.
+/// @param range the key range, as long long keys
+/// @return the selected ints, in order
+vector<int> selectInts(const Selection<long long>& range)
+{
+    string inName = string(TEST_DIR) + "/bounds.txt";
+    string outName = string(TEST_DIR) + "/selected.txt";
+    ofstream inFile(inName);
+    inFile << 9 << '\n' << INT_MAX << '\n' << -3 << '\n' << 1 << '\n' << INT_MIN << '\n' << 5 << '\n';
+    inFile.close();
+
+    selectFile<int, SortOrder<int> >(inName, outName, testOptions(64 << 10), keySelection<int>(range));
+    vector<int> selected;
+    ifstream outFile(outName);
+    int key;
+    while (outFile >> key)
+        selected.push_back(key);
+    return selected;
+}
+
+/// Count a check, and report it if it failed.
+/// @param passed whether the check passed
+/// @param what what was checked
+/// @return passed
+bool check(bool passed, const string& what)
+{
+    checkNum++;
+    if (!passed)
+        cout << "FAILED: " << what << endl;
+    return passed;
+}
@@ -0,0 +1,60 @@
+/**********************************************************************
+ * File name: extVerify.h
+ * -----------------------
+ * This file defines the verification of a sort: one streaming pass over
+ * a text file of records that checks whether it is in order, counts its
+ * records and sums a hash of every record.
+ *
+ * The checksum is a sum, so it does not depend on the order of the
+ * records: the input and the output of a sort that neither dropped nor
+ * duplicated a record have the same count and the same checksum. The
+ * hash of a record is taken over its run file coding (RecordCodec), so
+ * it does not depend on how the record was spaced in the text.
+ *
+ * This file defines the
+ *      verifyFile function:    verifies one file, or standard input.
+ *      verifyStream function:  verifies one text stream.
+ *      recordHash function:    the 64-bit hash of one record.
+ *      VerifyResult type:      what a verification found.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTVERIFY_H
+#define EXTVERIFY_H
+
+#include <iostream>    // istream
+#include <string>      // file names
+#include <vector>      // vector<char> coded record
+#include <cstdint>     // uint64_t
+#include "extSort.h"
+using namespace std;
+
+
+/*
+ * Type: VerifyResult
+ * ------------------
+ * What one pass over a file found.
+ */
+struct VerifyResult
+{
+    uint64_t recordNum;      // # of records
+    uint64_t checksum;       // sum of the hashes of the records
+    bool sorted;             // whether every record is in order after the one before it
+    uint64_t firstUnsorted;  // position of the first record out of order, if not sorted
+};
+
+
+// Function Prototypes:
+template <typename Record, typename Order>
+VerifyResult verifyFile(const string& fileName, bool strict = false, const Order& order = Order());
+template <typename Record, typename Order>
+VerifyResult verifyStream(istream& in, bool strict = false, const Order& order = Order());
+template <typename Record>
+uint64_t recordHash(const Record& record, vector<char>& bytes);
+
+#include "extVerify.t"
+
+#endif //EXTVERIFY_H
@@ -0,0 +1,111 @@
+/**********************************************************************
+ * File name: extVerify.t
+ * -----------------------
+ * This file implements the verification of a sort.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef EXTVERIFY_T
+#define EXTVERIFY_T
+
+#include <fstream>     // ifstream
+#include <utility>     // swap
+#include <stdexcept>   // runtime_error
+
+
+/*******************************************************************************************
+ * Function Name: verifyFile
+ * ------------------
+ * Purpose: To verify a text file of records, or standard input for STANDARD_STREAM.
+ *
+ * Input Parameters:
+ *          fileName: name of the file.
+ *          strict: whether records with equal keys count as out of order, as after a unique sort.
+ *          order: the order the records should be in.
+ * Output parameters: none.
+ * Return Value:
+ *          VerifyResult: the # of records, their checksum and whether they are in order.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+VerifyResult verifyFile(const string& fileName, bool strict, const Order& order)
+{
+    if (fileName == STANDARD_STREAM)
+        return verifyStream<Record>(cin, strict, order);
+    ifstream inFile(fileName, ios::binary);
+    if (!inFile)
+        throw runtime_error("Unable to open file \"" + fileName + "\"");
+    return verifyStream<Record>(inFile, strict, order);
+}
+
+
+/*******************************************************************************************
+ * Function Name: verifyStream
+ * ------------------
+ * Purpose: To verify a text stream of records in one pass: count the records, sum their
+ *          hashes and check that no record comes before the one before it.
+ *
+ * Input Parameters:
+ *          in: the text stream.
+ *          strict: whether records with equal keys count as out of order, as after a unique sort.
+ *          order: the order the records should be in.
+ * Output parameters: none.
+ * Return Value:
+ *          VerifyResult: the # of records, their checksum and whether they are in order.
+ *******************************************************************************************/
+template <typename Record, typename Order>
+VerifyResult verifyStream(istream& in, bool strict, const Order& order)
+{
+    TextReader<Record> inFile(in);
+    VerifyResult result = { 0, 0, true, 0 };
+    Record record = Record(), previous = Record();
+    vector<char> bytes;
+    while (inFile.read(record))
+    {
+        if (result.sorted && result.recordNum > 0
+            && (order(record, previous) || (strict && !order(previous, record))))
+        {
+            result.sorted = false;
+            result.firstUnsorted = result.recordNum;
+        }
+        result.checksum += recordHash(record, bytes);
+        result.recordNum++;
+        std::swap(record, previous);              // the next read overwrites record
+    }
+    return result;
+}
+
+
+/*******************************************************************************************
+ * Function Name: recordHash
+ * ------------------
+ * Purpose: To hash a record by its run file coding: FNV-1a over the bytes, then the
+ *          SplitMix64 finalizer, so that sums of hashes of similar records do not cancel.
+ *
+ * Input Parameters:
+ *          record: the record.
+ *          bytes: scratch space for the coding.
+ * Output parameters: none.
+ * Return Value:
+ *          uint64_t: the hash.
+ *******************************************************************************************/
+template <typename Record>
+uint64_t recordHash(const Record& record, vector<char>& bytes)
+{
+    bytes.resize(RecordCodec<Record>::size(record));
+    RecordCodec<Record>::encode(record, bytes.data());
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < bytes.size(); i++)
+        hash = (hash ^ static_cast<unsigned char>(bytes[i])) * 1099511628211ULL;
+
+    hash ^= hash >> 30;
+    hash *= 0xbf58476d1ce4e5b9ULL;
+    hash ^= hash >> 27;
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 31);
+}
+
+#endif //EXTVERIFY_T
@@ -0,0 +1,114 @@
+/**********************************************************************
+ * File name: logRecord.h
+ * -----------------------
+ * This file defines the LogRecord type, a line of a log file that
+ * starts with a numeric timestamp, and what the external sort needs
+ * to sort log files by timestamp:
+ *
+ *      LogRecord type:                one line of a log file.
+ *      LogTimestamp type:             key extractor, the timestamp.
+ *      RecordCodec<LogRecord> type:   variable-size run file format.
+ *      RecordText<LogRecord> type:    reads and writes whole lines.
+ *
+ * A line whose timestamp cannot be read gets timestamp 0, so it is
+ * kept rather than dropped.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <string>      // string line
+#include <cstdlib>     // strtoll
+#include <cstring>     // memcpy
+#include "extSort.h"
+using namespace std;
+
+
+/*
+ * Type: LogRecord
+ * ---------------
+ * One line of a log file, with its timestamp parsed. Its own swap is
+ * preferred to both std::swap and the swap template of
+ * sort_algorithms.t, which would otherwise be ambiguous in the STL
+ * algorithms.
+ */
+struct LogRecord
+{
+    long long timestamp;     // the number the line starts with
+    string line;             // the whole line, timestamp included
+
+    friend void swap(LogRecord& a, LogRecord& b)
+    {
+        std::swap(a.timestamp, b.timestamp);
+        a.line.swap(b.line);
+    }
+};
+
+/*
+ * Type: LogTimestamp
+ * ------------------
+ * The key extractor that orders log records by their timestamps.
+ */
+struct LogTimestamp
+{
+    long long operator()(const LogRecord& record) const { return record.timestamp; }
+};
+
+/*
+ * Type: RecordCodec<LogRecord>
+ * ----------------------------
+ * A log record is stored as its timestamp, a 32-bit length, then the
+ * characters of the line.
+ */
+template <>
+struct RecordCodec<LogRecord>
+{
+    static const uint32_t width = 0;
+    static size_t size(const LogRecord& record) { return sizeof(long long) + RecordCodec<string>::size(record.line); }
+    static size_t memory(const LogRecord& record) { return sizeof(LogRecord) + record.line.size(); }
+    static char* encode(const LogRecord& record, char* out)
+    {
+        memcpy(out, &record.timestamp, sizeof(long long));
+        return RecordCodec<string>::encode(record.line, out + sizeof(long long));
+    }
+    static const char* decode(const char* in, const char* end, LogRecord& record)
+    {
+        if (static_cast<size_t>(end - in) < sizeof(long long))
+            return nullptr;
+        const char* after = RecordCodec<string>::decode(in + sizeof(long long), end, record.line);
+        if (after != nullptr)
+            memcpy(&record.timestamp, in, sizeof(long long));
+        return after;
+    }
+};
+
+/*
+ * Type: RecordText<LogRecord>
+ * ---------------------------
+ * Log records are read and written as whole lines.
+ */
+template <>
+struct RecordText<LogRecord>
+{
+    static bool isSeparator(char c) { return c == '\n'; }
+    static const char* parse(const char* in, const char* end, LogRecord& record, bool atEnd)
+    {
+        const char* after = RecordText<string>::parse(in, end, record.line, atEnd);
+        if (after != nullptr)
+            record.timestamp = strtoll(record.line.c_str(), nullptr, 10);
+        return after;
+    }
+    static void format(const LogRecord& record, string& out)
+    {
+        out += record.line;
+        out += '\n';
+    }
+};
+
+typedef SortOrder<LogRecord, LogTimestamp> LogOrder;   // log records in timestamp order
+
+#endif //LOGRECORD_H
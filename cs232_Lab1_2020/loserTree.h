@@ -0,0 +1,92 @@
+/**********************************************************************
+ * File name: loserTree.h
+ * -----------------------
+ * This file defines the LoserTree class, a tournament tree used to
+ * merge k sorted runs at once.
+ *
+ * Each leaf holds the current record of one run. Every internal node
+ * remembers the loser of the match played at that node, and node 0
+ * remembers the overall winner, so replacing the winner with the next
+ * record of its run only replays the matches on one leaf-to-root path:
+ * log2(k) comparisons per record instead of k - 1.
+ *
+ * The tree is template based so that the user may decide the record
+ * type T and the comparison Compare (a "less than" function object).
+ * Records that compare equal are won by the lower-numbered run, so the
+ * merge is stable.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef LOSERTREE_H
+#define LOSERTREE_H
+
+#include <vector>      // vector<T> keys; vector<size_t> tree
+#include <functional>  // less<T>
+#include <cstddef>     // size_t
+using namespace std;
+
+
+/*
+ * Type: LoserTree
+ * ---------------
+ * This type represents a tournament tree of losers over k runs.
+ * T is the record class; Compare is the "less than" order of records.
+ */
+template <typename T, typename Compare = less<T> >
+class LoserTree
+{
+private:
+    size_t k;               // number of leaves (runs)
+    vector<T> keys;         // current record of each run
+    vector<char> live;      // whether a run still has a current record
+    vector<size_t> tree;    // tree[0] is the winner, tree[1..k-1] the losers
+    Compare cmp;            // "less than" order of records
+
+    /* Test whether the record of leaf a beats (comes before) the record of leaf b */
+    bool beats(size_t a, size_t b) const;
+
+    /* Recursive utility that plays all matches below a node and returns its winner */
+    size_t build(size_t node);
+
+    /* Replay the matches from a leaf up to the root */
+    void replay(size_t leaf);
+
+public:
+    /* Constructor */
+    explicit LoserTree(size_t k, Compare cmp = Compare());
+
+    /* Return the number of runs in the tree */
+    size_t size() const { return k; }
+
+    /* Set the first record of a run before the tree is built */
+    void setLeaf(size_t i, const T& key);
+
+    /* Mark a run as empty before the tree is built */
+    void setExhausted(size_t i);
+
+    /* Play all matches once all leaves are set */
+    void build();
+
+    /* Test whether every run is exhausted */
+    bool empty() const { return !live[tree[0]]; }
+
+    /* Return the run that holds the smallest record */
+    size_t top() const { return tree[0]; }
+
+    /* Return the smallest record */
+    const T& topKey() const { return keys[tree[0]]; }
+
+    /* Replace the smallest record with the next record of its run */
+    void replaceTop(const T& key);
+
+    /* Remove the smallest record when its run has no more records */
+    void exhaustTop();
+
+}; /* end of LoserTree class */
+
+#include "loserTree.t"
+
+#endif //LOSERTREE_H
@@ -0,0 +1,164 @@
+/**********************************************************************
+ * File name: loserTree.t
+ * -----------------------
+ * This file implements all templated functions of the LoserTree class.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef LOSERTREE_T
+#define LOSERTREE_T
+
+/*******************************************************************************************
+ * Constructor: LoserTree
+ * ------------------
+ * Purpose: To initialize a tree of k runs that are all exhausted.
+ *
+ * Input Parameters:
+ *          k: number of runs, at least 1.
+ *          cmp: "less than" order of records.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+LoserTree<T, Compare>::LoserTree(size_t k, Compare cmp)
+    : k(k == 0 ? 1 : k), keys(this->k), live(this->k, 0), tree(this->k, 0), cmp(cmp)
+{
+}
+
+
+/*******************************************************************************************
+ * Function Name: beats
+ * ------------------
+ * Purpose: To decide the match between two leaves. An exhausted run always loses,
+ *          and equal records are won by the lower-numbered run.
+ *
+ * Input Parameters:
+ *          a, b: leaf indices.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: true if leaf a wins against leaf b.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+bool LoserTree<T, Compare>::beats(size_t a, size_t b) const
+{
+    if (!live[a]) return false;
+    if (!live[b]) return true;
+    if (cmp(keys[a], keys[b])) return true;
+    if (cmp(keys[b], keys[a])) return false;
+    return a < b;
+}
+
+
+/*******************************************************************************************
+ * Function Name: setLeaf / setExhausted
+ * ------------------
+ * Purpose: To set up a leaf before the tree is built.
+ *
+ * Input Parameters:
+ *          i: leaf index.
+ *          key: first record of run i.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::setLeaf(size_t i, const T& key)
+{
+    keys[i] = key;
+    live[i] = 1;
+}
+
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::setExhausted(size_t i)
+{
+    live[i] = 0;
+}
+
+
+/*******************************************************************************************
+ * Function Name: build
+ * ------------------
+ * Purpose: To play all matches of the tree. Node n has children 2n and 2n+1;
+ *          a child index m >= k stands for leaf m - k.
+ *
+ * Input Parameters:
+ *          node: root of the subtree to play.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the leaf that wins the subtree.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+size_t LoserTree<T, Compare>::build(size_t node)
+{
+    if (node >= k)
+        return node - k;
+
+    size_t left = build(2 * node);
+    size_t right = build(2 * node + 1);
+    if (beats(left, right))
+    {
+        tree[node] = right;     // the loser stays at the node
+        return left;            // the winner moves up
+    }
+    tree[node] = left;
+    return right;
+}
+
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::build()
+{
+    tree[0] = (k == 1) ? 0 : build(1);
+}
+
+
+/*******************************************************************************************
+ * Function Name: replay
+ * ------------------
+ * Purpose: To replay the matches on the path from a changed leaf to the root.
+ *
+ * Input Parameters:
+ *          leaf: the leaf whose record has changed.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::replay(size_t leaf)
+{
+    size_t winner = leaf;
+    for (size_t node = (leaf + k) / 2; node > 0; node /= 2)
+    {
+        if (beats(tree[node], winner))
+            std::swap(tree[node], winner);   // the old loser goes on, the winner stays behind
+    }
+    tree[0] = winner;
+}
+
+
+/*******************************************************************************************
+ * Function Name: replaceTop / exhaustTop
+ * ------------------
+ * Purpose: To advance the winning run to its next record, or to remove it
+ *          from the tournament when it has no more records.
+ *
+ * Input Parameters:
+ *          key: next record of the winning run.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::replaceTop(const T& key)
+{
+    keys[tree[0]] = key;
+    replay(tree[0]);
+}
+
+template <typename T, typename Compare>
+void LoserTree<T, Compare>::exhaustTop()
+{
+    live[tree[0]] = 0;
+    replay(tree[0]);
+}
+
+#endif //LOSERTREE_T
@@ -0,0 +1,116 @@
+/**********************************************************************
+ * File name: mappedFile.h
+ * -----------------------
+ * This file defines the MappedFile class, which makes the whole of a
+ * file readable as one array of characters without reading it first.
+ *
+ * On POSIX systems the file is memory-mapped, so its pages are read
+ * by the operating system as they are first touched and take no room
+ * in the heap. Elsewhere the file is read into memory instead, so a
+ * file larger than the caller can hold is left unopened, unread, on
+ * either system.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>      // fileName
+#include <vector>      // vector<char> contents
+#include <fstream>     // ifstream
+#include <cstdint>     // SIZE_MAX
+#include <filesystem>  // file_size
+#ifndef _WIN32
+#include <fcntl.h>     // open
+#include <unistd.h>    // close
+#include <sys/mman.h>  // mmap, munmap, madvise
+#include <sys/stat.h>  // fstat
+#endif
+using namespace std;
+
+
+/*
+ * Type: MappedFile
+ * ----------------
+ * This type maps a whole file for reading.
+ */
+class MappedFile
+{
+private:
+    const char* start;       // first character of the file
+    size_t length;           // # of characters in the file
+    bool opened;             // whether the file could be opened
+    bool mapped;             // whether start is a mapping to unmap
+    vector<char> contents;   // the file, when it is read instead of mapped
+
+public:
+    /* Constructor, which leaves a file of more than maxBytes characters unopened */
+    explicit MappedFile(const string& fileName, size_t maxBytes = SIZE_MAX)
+        : start(nullptr), length(0), opened(false), mapped(false)
+    {
+#ifndef _WIN32
+        int fd = open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && static_cast<uintmax_t>(info.st_size) <= maxBytes)
+        {
+            opened = true;
+            length = static_cast<size_t>(info.st_size);
+            if (length > 0)
+            {
+                void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED)
+                {
+                    madvise(addr, length, MADV_WILLNEED);
+                    start = static_cast<const char*>(addr);
+                    mapped = true;
+                }
+                else
+                    opened = false;
+            }
+        }
+        ::close(fd);
+#else
+        error_code error;
+        uintmax_t fileSize = filesystem::file_size(fileName, error);
+        if (error || fileSize > maxBytes)        // checked before a single byte is read
+            return;
+        ifstream inFile(fileName, ios::binary);
+        if (!inFile)
+            return;
+        contents.assign(istreambuf_iterator<char>(inFile), istreambuf_iterator<char>());
+        start = contents.data();
+        length = contents.size();
+        opened = true;
+#endif
+    }
+
+    /* A mapping is owned by one object, so it is not copied */
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /* Destructor */
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(const_cast<char*>(start), length);
+#endif
+    }
+
+    /* Test whether the file could be opened and mapped */
+    bool isOpen() const { return opened; }
+
+    /* Return the first character of the file */
+    const char* data() const { return start; }
+
+    /* Return the # of characters in the file */
+    size_t size() const { return length; }
+
+}; /* end of MappedFile class */
+
+#endif //MAPPEDFILE_H
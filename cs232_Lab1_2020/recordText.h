@@ -0,0 +1,247 @@
+/**********************************************************************
+ * File name: recordText.h
+ * -----------------------
+ * This file defines how the external sort reads and writes records
+ * as text: the RecordText codec of a record type, and the TextReader
+ * and TextWriter classes that move text through large buffers.
+ *
+ * The input and the final output are the only text the sort handles,
+ * but for every record it has to be parsed and formatted once, so it
+ * is done a buffer at a time rather than one stream operation at a
+ * time. Integers are parsed with from_chars and formatted with
+ * to_chars, which neither look at the locale nor copy the token.
+ *
+ * The file name "-" (STANDARD_STREAM) stands for standard input or
+ * standard output, so the sort can sit in a pipeline.
+ *
+ * This file defines the
+ *      RecordText type:   parses and formats one record type.
+ *      TextReader class:  reads records from a stream through a buffer.
+ *      TextWriter class:  writes records to a file through a buffer.
+ *      openTextOutput:    opens a text output file, or standard output.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef RECORDTEXT_H
+#define RECORDTEXT_H
+
+#include <iostream>     // istream
+#include <fstream>      // ofstream
+#include <sstream>      // istringstream, ostringstream
+#include <string>       // string buffer; string records
+#include <vector>       // vector<char> buffer
+#include <charconv>     // from_chars, to_chars
+#include <stdexcept>    // runtime_error
+#include <type_traits>  // is_integral
+#include "sortStats.h"
+using namespace std;
+
+
+const size_t TEXT_BUFFER_BYTES = 1 << 16;   // bytes of text read or written at a time
+const char* const STANDARD_STREAM = "-";    // the file name of standard input or output
+
+/*
+ * Type: RecordText
+ * ----------------
+ * This type parses and formats records of type T as text:
+ *
+ *      isSeparator:  tells where text may be cut between two records.
+ *      parse:        skips separators and parses the record that starts
+ *                    in [in, end), returns the character after it, or
+ *                    nullptr if no whole record is in the range. Unless
+ *                    atEnd, a record that runs to end may go on past it.
+ *      format:       appends a record to out.
+ *
+ * This general version parses every token between separators with >>
+ * and formats records with <<, separated by two spaces.
+ */
+template <typename T, bool = is_integral<T>::value>
+struct RecordText
+{
+    static bool isSeparator(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+    static const char* parse(const char* in, const char* end, T& record, bool atEnd)
+    {
+        while (in != end && isSeparator(*in))
+            in++;
+        const char* stop = in;
+        while (stop != end && !isSeparator(*stop))
+            stop++;
+        if (in == end || (stop == end && !atEnd))
+            return nullptr;
+        istringstream token(string(in, stop));
+        if (!(token >> record))
+            throw runtime_error("\"" + string(in, stop) + "\" is not a valid record");
+        return stop;
+    }
+
+    static void format(const T& record, string& out)
+    {
+        ostringstream text;
+        text << record << "  ";
+        out += text.str();
+    }
+};
+
+/*
+ * Type: RecordText<T, true>
+ * -------------------------
+ * Integers are parsed with from_chars and formatted with to_chars,
+ * straight from and into the buffers. A leading '+' is accepted as
+ * >> does.
+ */
+template <typename T>
+struct RecordText<T, true>
+{
+    static bool isSeparator(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+    static const char* parse(const char* in, const char* end, T& record, bool atEnd)
+    {
+        while (in != end && isSeparator(*in))
+            in++;
+        const char* stop = in;
+        while (stop != end && !isSeparator(*stop))
+            stop++;
+        if (in == end || (stop == end && !atEnd))
+            return nullptr;                      // the number may go on in the next buffer
+
+        const char* first = (*in == '+' && stop - in > 1) ? in + 1 : in;
+        from_chars_result result = from_chars(first, stop, record);
+        if (result.ec != errc() || result.ptr != stop)
+            throw runtime_error("\"" + string(in, stop) + "\" is not a valid integer");
+        return stop;
+    }
+
+    static void format(const T& record, string& out)
+    {
+        char digits[24];                         // 20 digits and a sign at most
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), record);
+        out.append(digits, result.ptr);
+        out.append("  ", 2);
+    }
+};
+
+/*
+ * Type: RecordText<string>
+ * ------------------------
+ * String records are whole lines of text.
+ */
+template <>
+struct RecordText<string>
+{
+    static bool isSeparator(char c) { return c == '\n'; }
+
+    static const char* parse(const char* in, const char* end, string& record, bool atEnd)
+    {
+        if (in == end)
+            return nullptr;
+        const char* stop = in;
+        while (stop != end && *stop != '\n')
+            stop++;
+        if (stop == end && !atEnd)
+            return nullptr;                      // the line may go on in the next buffer
+        record.assign(in, stop);
+        return (stop == end) ? stop : stop + 1;
+    }
+
+    static void format(const string& record, string& out)
+    {
+        out += record;
+        out += '\n';
+    }
+};
+
+
+/*
+ * Type: TextReader
+ * ----------------
+ * This type reads records of type T from a text stream through a
+ * buffer of bufferBytes. A record cut at the end of the buffer is
+ * moved to its front before the next read; a record longer than the
+ * whole buffer makes the buffer grow.
+ */
+template <typename T>
+class TextReader
+{
+private:
+    istream& in;             // the text stream
+    vector<char> buffer;     // text being parsed
+    size_t pos, end;         // next and one past the last valid character in the buffer
+    bool atEnd;              // whether the stream has no more text
+
+    /* Keep the unparsed text and read more after it */
+    void fill();
+
+public:
+    /* Constructor */
+    explicit TextReader(istream& in, size_t bufferBytes = TEXT_BUFFER_BYTES);
+
+    /* Read the next record, return false at the end of the text */
+    bool read(T& record)
+    {
+        const char* after;
+        while ((after = RecordText<T>::parse(buffer.data() + pos, buffer.data() + end, record, atEnd)) == nullptr)
+        {
+            if (atEnd)
+                return false;
+            fill();
+        }
+        pos = after - buffer.data();
+        return true;
+    }
+
+}; /* end of TextReader class */
+
+
+/*
+ * Type: TextWriter
+ * ----------------
+ * This type writes records of type T to a text file through a buffer,
+ * with the same write() interface as RunWriter, so the final merge can
+ * produce the text output file.
+ */
+template <typename T>
+class TextWriter
+{
+private:
+    string fileName;         // name of the text file, for error messages
+    ofstream outFile;        // the text file, unless the output is standard output
+    ostream& out;            // the text file or standard output
+    bool open;               // whether the text is not complete yet
+    string buffer;           // text not written yet
+    uint64_t count;          // # of records written
+
+    /* Write the buffered text to the file */
+    void flush();
+
+public:
+    /* Constructor */
+    explicit TextWriter(const string& fileName);
+
+    /* Destructor */
+    ~TextWriter();
+
+    /* Append one record */
+    void write(const T& record)
+    {
+        RecordText<T>::format(record, buffer);
+        count++;
+        if (buffer.size() >= TEXT_BUFFER_BYTES)
+            flush();
+    }
+
+    /* Write the buffered text and close the file */
+    void close();
+
+}; /* end of TextWriter class */
+
+
+// Function Prototypes:
+ostream& openTextOutput(const string& fileName, ofstream& outFile);
+
+#include "recordText.t"
+
+#endif //RECORDTEXT_H
@@ -0,0 +1,167 @@
+/**********************************************************************
+ * File name: recordText.t
+ * -----------------------
+ * This file implements all templated functions of the TextReader and
+ * TextWriter classes.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef RECORDTEXT_T
+#define RECORDTEXT_T
+
+#include <algorithm>   // copy
+
+/*******************************************************************************************
+ * Constructor: TextReader
+ * ------------------
+ * Purpose: To set up a reader over a text stream.
+ *
+ * Input Parameters:
+ *          in: the text stream.
+ *          bufferBytes: # of characters read at a time.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+TextReader<T>::TextReader(istream& in, size_t bufferBytes)
+    : in(in), buffer(bufferBytes > 0 ? bufferBytes : 1), pos(0), end(0), atEnd(false)
+{
+}
+
+
+/*******************************************************************************************
+ * Function Name: fill
+ * ------------------
+ * Purpose: To move the unparsed text to the front of the buffer and read more after it.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void TextReader<T>::fill()
+{
+    size_t leftover = end - pos;
+    copy(buffer.begin() + pos, buffer.begin() + end, buffer.begin());
+    if (leftover == buffer.size())          // a record longer than the whole buffer
+        buffer.resize(2 * buffer.size());
+
+    size_t wanted = buffer.size() - leftover;
+    {
+        IoTimer timer;
+        in.read(buffer.data() + leftover, wanted);
+    }
+    size_t got = static_cast<size_t>(in.gcount());
+    sortStats().addBytesRead(got);
+    pos = 0;
+    end = leftover + got;
+    atEnd = got < wanted;
+}
+
+
+/*******************************************************************************************
+ * Function Name: openTextOutput
+ * ------------------
+ * Purpose: To create a text output file, or to pick standard output for STANDARD_STREAM.
+ *
+ * Input Parameters:
+ *          fileName: name of the text file.
+ * Output parameters:
+ *          outFile: the stream of the file, left closed for standard output.
+ * Return Value:
+ *          ostream&: the stream to write the text to.
+ *******************************************************************************************/
+inline ostream& openTextOutput(const string& fileName, ofstream& outFile)
+{
+    if (fileName == STANDARD_STREAM)
+        return cout;
+    outFile.open(fileName, ios::binary | ios::trunc);
+    if (!outFile)
+        throw runtime_error("Unable to create output file \"" + fileName + "\"");
+    return outFile;
+}
+
+
+/*******************************************************************************************
+ * Constructor: TextWriter
+ * ------------------
+ * Purpose: To create the text file, or to write to standard output.
+ *
+ * Input Parameters:
+ *          fileName: name of the text file, or STANDARD_STREAM.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+TextWriter<T>::TextWriter(const string& fileName)
+    : fileName(fileName), out(openTextOutput(fileName, outFile)), open(true), count(0)
+{
+    buffer.reserve(TEXT_BUFFER_BYTES + 64);
+}
+
+
+/*******************************************************************************************
+ * Destructor: TextWriter
+ * ------------------
+ * Purpose: To make sure the text file is complete when the writer goes out of scope.
+ *          A write error here is dropped: the writer only goes out of scope unclosed
+ *          when the sort is already failing.
+ *******************************************************************************************/
+template <typename T>
+TextWriter<T>::~TextWriter()
+{
+    if (!open)
+        return;
+    try {
+        close();
+    }
+    catch (...) {
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: flush / close
+ * ------------------
+ * Purpose: To write the buffered text to the file, and to close the file after it.
+ *          A write error, such as a full disk, is thrown rather than left as a
+ *          short output file.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void TextWriter<T>::flush()
+{
+    {
+        IoTimer timer;
+        out.write(buffer.data(), buffer.size());
+    }
+    if (!out)
+        throw runtime_error("Unable to write output file \"" + fileName + "\"");
+    sortStats().addBytesWritten(buffer.size());
+    buffer.clear();
+}
+
+template <typename T>
+void TextWriter<T>::close()
+{
+    open = false;
+    flush();
+    {
+        IoTimer timer;
+        out.flush();
+        if (outFile.is_open())
+            outFile.close();
+    }
+    if (!out)
+        throw runtime_error("Unable to write output file \"" + fileName + "\"");
+    sortStats().addRecordsWritten(count);
+    count = 0;
+}
+
+#endif //RECORDTEXT_T
@@ -0,0 +1,256 @@
+/**********************************************************************
+ * File name: reducers.h
+ * -----------------------
+ * This file defines the reducers of the external sort, which collapse
+ * records with equal keys into one as the sort writes them, so a sort
+ * can dedupe or count without a scan of its output afterwards.
+ *
+ * A reducer is any callable reducer(into, from) that combines record
+ * from into record into, which has the same key and was written just
+ * before it. Records are combined as soon as they meet: when a run is
+ * written, and again in every merge, so later passes move less data.
+ *
+ * This file defines the
+ *      KeepAll type:         the reducer that keeps every record.
+ *      KeepFirst type:       keeps one record per key (unique).
+ *      AddCounts type:       counts the records per key.
+ *      Counted type:         a record with the # of records it stands for.
+ *      CountedKey type:      key extractor of counted records.
+ *      Reduction class:      applies a reducer to a sorted stream of records.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef REDUCERS_H
+#define REDUCERS_H
+
+#include <string>      // string out
+#include <cstdint>     // uint64_t
+#include <cstring>     // memcpy
+#include <charconv>    // to_chars
+#include <utility>     // declval
+#include "runFile.h"
+#include "recordText.h"
+using namespace std;
+
+
+/*
+ * Type: KeepAll
+ * -------------
+ * The reducer of a plain sort: no records are combined.
+ */
+struct KeepAll
+{
+    template <typename Record>
+    void operator()(Record&, const Record&) const {}
+};
+
+/*
+ * Type: KeepFirst
+ * ---------------
+ * Keeps the first record of every key the sort meets and drops the rest.
+ */
+struct KeepFirst
+{
+    template <typename Record>
+    void operator()(Record&, const Record&) const {}
+};
+
+/*
+ * Type: ReducerTraits
+ * -------------------
+ * Tells whether a reducer combines records at all.
+ */
+template <typename Reducer>
+struct ReducerTraits
+{
+    static const bool reduces = true;
+};
+
+template <>
+struct ReducerTraits<KeepAll>
+{
+    static const bool reduces = false;
+};
+
+
+/*
+ * Type: Counted
+ * -------------
+ * A record with the # of input records it stands for. Every record
+ * read from the input counts 1. Its own swap is preferred to both
+ * std::swap and the swap template of sort_algorithms.t, which would
+ * otherwise be ambiguous in the STL algorithms.
+ */
+template <typename T>
+struct Counted
+{
+    T record;                // the record
+    uint64_t count;          // # of input records with its key
+
+    friend void swap(Counted& a, Counted& b)
+    {
+        std::swap(a.record, b.record);
+        std::swap(a.count, b.count);
+    }
+};
+
+/*
+ * Type: AddCounts
+ * ---------------
+ * Counts the records per key: the counts of records with equal keys add up.
+ */
+struct AddCounts
+{
+    template <typename T>
+    void operator()(Counted<T>& into, const Counted<T>& from) const { into.count += from.count; }
+};
+
+/*
+ * Type: CountedKey
+ * ----------------
+ * The key extractor of counted records: the key of the record, by KeyOf.
+ */
+template <typename KeyOf>
+struct CountedKey
+{
+    KeyOf keyOf;             // extracts the key of the record
+
+    template <typename T>
+    auto operator()(const Counted<T>& counted) const -> decltype(declval<const KeyOf&>()(counted.record))
+    {
+        return keyOf(counted.record);
+    }
+};
+
+/*
+ * Type: RecordCodec<Counted<T>>
+ * -----------------------------
+ * A counted record is stored as its 64-bit count, then the record.
+ */
+template <typename T>
+struct RecordCodec<Counted<T> >
+{
+    static const uint32_t width = (RecordCodec<T>::width > 0) ? RecordCodec<T>::width + sizeof(uint64_t) : 0;
+    static size_t size(const Counted<T>& counted) { return sizeof(uint64_t) + RecordCodec<T>::size(counted.record); }
+    static size_t memory(const Counted<T>& counted) { return sizeof(uint64_t) + RecordCodec<T>::memory(counted.record); }
+    static char* encode(const Counted<T>& counted, char* out)
+    {
+        memcpy(out, &counted.count, sizeof(uint64_t));
+        return RecordCodec<T>::encode(counted.record, out + sizeof(uint64_t));
+    }
+    static const char* decode(const char* in, const char* end, Counted<T>& counted)
+    {
+        if (static_cast<size_t>(end - in) < sizeof(uint64_t))
+            return nullptr;
+        const char* after = RecordCodec<T>::decode(in + sizeof(uint64_t), end, counted.record);
+        if (after != nullptr)
+            memcpy(&counted.count, in, sizeof(uint64_t));
+        return after;
+    }
+};
+
+/*
+ * Type: RecordText<Counted<T>>
+ * ----------------------------
+ * Counted records are read as plain records that count 1, and written
+ * one per line as the count, a space, and the record, like uniq -c.
+ */
+template <typename T>
+struct RecordText<Counted<T>, false>
+{
+    static bool isSeparator(char c) { return RecordText<T>::isSeparator(c); }
+
+    static const char* parse(const char* in, const char* end, Counted<T>& counted, bool atEnd)
+    {
+        counted.count = 1;
+        return RecordText<T>::parse(in, end, counted.record, atEnd);
+    }
+
+    static void format(const Counted<T>& counted, string& out)
+    {
+        char digits[24];
+        to_chars_result result = to_chars(digits, digits + sizeof(digits), counted.count);
+        out.append(digits, result.ptr);
+        out += ' ';
+        size_t start = out.size();
+        RecordText<T>::format(counted.record, out);
+        if (out.size() > start && out.back() == '\n')      // the record is a line already
+            return;
+        while (out.size() > start && (out.back() == ' ' || out.back() == '\t'))
+            out.pop_back();
+        out += '\n';
+    }
+};
+
+
+/*
+ * Type: Reduction
+ * ---------------
+ * Passes records written in sorted order on to a writer, combining a
+ * record whose key equals the one before it into that one instead of
+ * writing it. The last record is held back until flush. With KeepAll
+ * every record is written at once. With a limit, only the first limit
+ * records are written and the rest are dropped.
+ */
+template <typename Record, typename Order, typename Reducer>
+class Reduction
+{
+private:
+    const Order& order;      // the order of the records
+    const Reducer& reducer;  // combines records with equal keys
+    Record pending;          // the record that the next ones may be combined into
+    bool held;               // whether there is a pending record
+    uint64_t limit;          // max # of records to write, 0 for all
+    uint64_t written;        // # of records written
+
+public:
+    /* Constructor */
+    Reduction(const Order& order, const Reducer& reducer, uint64_t limit = 0)
+        : order(order), reducer(reducer), pending(), held(false), limit(limit), written(0) {}
+
+    /* Test whether the limit has been reached, so later records are dropped */
+    bool full() const { return limit > 0 && written >= limit; }
+
+    /* Pass on one record */
+    template <typename Writer>
+    void write(Writer& out, const Record& record)
+    {
+        if (full())
+            return;
+        if (!ReducerTraits<Reducer>::reduces)
+        {
+            out.write(record);
+            written++;
+        }
+        else if (held && !order(pending, record))   // in sorted order, not before means the same key
+            reducer(pending, record);
+        else
+        {
+            if (held)
+            {
+                out.write(pending);
+                written++;
+            }
+            pending = record;
+            held = !full();
+        }
+    }
+
+    /* Write the pending record */
+    template <typename Writer>
+    void flush(Writer& out)
+    {
+        if (held)
+        {
+            out.write(pending);
+            written++;
+        }
+        held = false;
+    }
+
+}; /* end of Reduction class */
+
+#endif //REDUCERS_H
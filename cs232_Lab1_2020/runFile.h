@@ -0,0 +1,412 @@
+/**********************************************************************
+ * File name: runFile.h
+ * -----------------------
+ * This file defines the binary file format of the sorted runs used by
+ * the external sort, and the RunWriter and RunReader classes that
+ * write and read it a whole block of records at a time.
+ *
+ * A run file starts with a RunHeader followed by recordCount records
+ * in dataBytes bytes. How a record is laid out is decided by its
+ * RecordCodec: fixed-size records of keyWidth bytes each are stored
+ * exactly as they are in memory, and variable-size records (keyWidth
+ * 0) carry a length prefix. Only the original input and the final
+ * output of the sort are text.
+ *
+ * Both classes split their buffer in two halves. While the caller
+ * works on one half, the other half is read from or written to the
+ * file by a background task, so a merge that keeps many runs open
+ * does not stall on every buffer refill. Halves smaller than
+ * ASYNC_IO_BYTES are transferred in the caller's thread instead.
+ *
+ * Runs of integers may instead be delta coded (RUN_DELTA): every record
+ * is stored as its difference from the record before it, zigzag mapped
+ * to an unsigned number and written as a varint of 7 bits per byte.
+ * Neighboring records of a sorted run are close, so most records take
+ * one or two bytes instead of four or eight. A delta coded run is
+ * still read front to back in one stream.
+ *
+ * A file may also hold several runs one after another, each with its
+ * own header, like the tapes of a polyphase merge.
+ *
+ * When every record has the same width, a run can also be read or
+ * written in independent slices, so several threads can merge
+ * disjoint key ranges of the same runs into the same output file.
+ *
+ * The classes are template based so that the user may decide the
+ * record type T. A trivially copyable T is a fixed-size record; any
+ * other type needs a RecordCodec specialization.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef RUNFILE_H
+#define RUNFILE_H
+
+#include <fstream>      // ifstream, ofstream
+#include <string>       // fileName; string records
+#include <vector>       // vector<char> buffer
+#include <stdexcept>    // runtime_error
+#include <cstdint>      // uint32_t, uint64_t
+#include <cstring>      // memcpy
+#include <type_traits>  // is_trivially_copyable
+#include <future>       // future<size_t> pending; async
+#include "sortStats.h"
+using namespace std;
+
+
+const uint32_t RUN_MAGIC = 0x4E555233;     // "3RUN" in a little-endian file
+const uint32_t RUN_SORTED = 1;             // flag: the records are in non-decreasing order
+const uint32_t RUN_DELTA = 2;              // flag: the records are delta coded varints
+const size_t MAX_VARINT_BYTES = 10;        // bytes of the longest varint of 64 bits
+const size_t ASYNC_IO_BYTES = 1 << 16;     // smallest half buffer worth a background transfer
+
+/*
+ * Type: RunHeader
+ * ---------------
+ * This type is the header at the start of every run file.
+ */
+struct RunHeader
+{
+    uint32_t magic;          // RUN_MAGIC, to recognize run files
+    uint32_t keyWidth;       // bytes per record, 0 for variable-size records
+    uint64_t recordCount;    // number of records that follow the header
+    uint64_t dataBytes;      // number of bytes of those records
+    uint32_t flags;          // RUN_SORTED, RUN_DELTA, ...
+    uint32_t reserved;       // always 0, keeps the header 32 bytes
+};
+
+
+/*
+ * Type: RecordCodec
+ * -----------------
+ * This type tells the run files how records of type T are stored.
+ * This general version stores a trivially copyable T as its bytes.
+ *
+ *      width:   bytes per record, or 0 for variable-size records.
+ *      size:    bytes one record takes in a run file.
+ *      memory:  bytes one record takes in memory, for the memory budget.
+ *      encode:  store a record at out, return the byte after it.
+ *      decode:  load a record from [in, end), return the byte after it,
+ *               or nullptr if the record is not complete in that range.
+ */
+template <typename T>
+struct RecordCodec
+{
+    static_assert(is_trivially_copyable<T>::value, "records without a RecordCodec must be trivially copyable");
+
+    static const uint32_t width = sizeof(T);
+    static size_t size(const T&) { return sizeof(T); }
+    static size_t memory(const T&) { return sizeof(T); }
+    static char* encode(const T& record, char* out)
+    {
+        memcpy(out, &record, sizeof(T));
+        return out + sizeof(T);
+    }
+    static const char* decode(const char* in, const char* end, T& record)
+    {
+        if (static_cast<size_t>(end - in) < sizeof(T))
+            return nullptr;
+        memcpy(&record, in, sizeof(T));
+        return in + sizeof(T);
+    }
+};
+
+/*
+ * Type: RecordCodec<string>
+ * -------------------------
+ * Strings are variable-size records: a 32-bit length, then the characters.
+ */
+template <>
+struct RecordCodec<string>
+{
+    static const uint32_t width = 0;
+    static size_t size(const string& record) { return sizeof(uint32_t) + record.size(); }
+    static size_t memory(const string& record) { return sizeof(string) + record.size(); }
+    static char* encode(const string& record, char* out)
+    {
+        uint32_t length = static_cast<uint32_t>(record.size());
+        memcpy(out, &length, sizeof(length));
+        memcpy(out + sizeof(length), record.data(), length);
+        return out + sizeof(length) + length;
+    }
+    static const char* decode(const char* in, const char* end, string& record)
+    {
+        uint32_t length;
+        if (static_cast<size_t>(end - in) < sizeof(length))
+            return nullptr;
+        memcpy(&length, in, sizeof(length));
+        if (static_cast<size_t>(end - in) - sizeof(length) < length)
+            return nullptr;
+        record.assign(in + sizeof(length), length);
+        return in + sizeof(length) + length;
+    }
+};
+
+
+/*
+ * Type: DeltaVarint
+ * -----------------
+ * This type delta codes records of type T with zigzag varints. Only
+ * integer records can be delta coded; for any other T, supported is
+ * false and a run is never written with RUN_DELTA.
+ *
+ *      encode:  store record as its difference from prev, return the
+ *               byte after it, and make record the new prev.
+ *      decode:  load the record that follows prev from [in, end), return
+ *               the byte after it, or nullptr if it is not complete.
+ */
+template <typename T, bool = is_integral<T>::value>
+struct DeltaVarint
+{
+    static const bool supported = false;
+    static char* encode(const T&, uint64_t&, char* out) { return out; }
+    static const char* decode(const char*, const char*, uint64_t&, T&) { return nullptr; }
+};
+
+template <typename T>
+struct DeltaVarint<T, true>
+{
+    static const bool supported = true;
+    static char* encode(const T& record, uint64_t& prev, char* out)
+    {
+        uint64_t value = static_cast<uint64_t>(record);
+        uint64_t delta = value - prev;                                       // wraps like the records do
+        uint64_t zigzag = (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+        prev = value;
+        while (zigzag >= 0x80)
+        {
+            *out++ = static_cast<char>(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *out++ = static_cast<char>(zigzag);
+        return out;
+    }
+    static const char* decode(const char* in, const char* end, uint64_t& prev, T& record)
+    {
+        uint64_t zigzag = 0;
+        for (int shift = 0; in != end; shift += 7)
+        {
+            unsigned char byte = static_cast<unsigned char>(*in++);
+            zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80)
+            {
+                prev += (zigzag >> 1) ^ (0 - (zigzag & 1));
+                record = static_cast<T>(prev);
+                return in;
+            }
+        }
+        return nullptr;
+    }
+};
+
+
+/* Read and check the header of an open run file */
+inline RunHeader readRunHeader(ifstream& inFile, const string& fileName, size_t keyWidth);
+
+/* Write the header of a run file of fixed-size records that are written as slices */
+inline void createRunFile(const string& fileName, size_t keyWidth, uint64_t recordCount, bool sorted = true);
+
+/* Read the record at a position of an open run file of fixed-size records */
+template <typename T>
+T readRecordAt(ifstream& inFile, uint64_t index);
+
+/* Return the position of the first record not less than key in an open sorted run file */
+template <typename T, typename Less>
+uint64_t lowerBoundInRun(ifstream& inFile, uint64_t recordCount, const T& key, const Less& less);
+
+
+/*
+ * Type: RunWriter
+ * ---------------
+ * This type writes records of type T to a run file through two
+ * buffers of bufferBytes / 2 bytes: one is filled while the other is
+ * written. A record larger than a buffer gets a buffer of its own
+ * size. The record count in the header is filled in when the writer
+ * is closed. An appending writer adds its run after the runs already
+ * in the file. A slice writer instead writes its fixed-size records
+ * from a given position of a file made by createRunFile and leaves
+ * the header alone.
+ */
+template <typename T>
+class RunWriter
+{
+private:
+    typedef RecordCodec<T> Codec;  // for convenience
+
+    string fileName;         // name of the run file, for error messages
+    ofstream outFile;        // the run file
+    vector<char> buffer;     // bytes being filled
+    vector<char> spare;      // bytes being written in the background
+    size_t used;             // number of bytes in the buffer
+    uint64_t count;          // number of records written so far
+    uint64_t bytes;          // number of bytes handed to the file so far
+    uint32_t flags;          // header flags
+    bool delta;              // records are delta coded
+    uint64_t prev;           // the last record written, for delta coding
+    bool slice;              // writes part of an existing run file
+    streamoff headerPos;     // where the header of this run is in the file
+    launch mode;             // launch::async for large buffers, launch::deferred for small ones
+    future<size_t> pending;  // the background write of spare
+
+    /* Write the first n bytes of spare to the file */
+    size_t writeChunk(size_t n);
+
+    /* Start writing the buffered bytes and switch to the other buffer */
+    void flush();
+
+    /* Make room in the buffer for a record of n bytes */
+    void makeRoom(size_t n);
+
+    /* Wait for the background write to finish */
+    void wait();
+
+public:
+    /* Constructor */
+    RunWriter(const string& fileName, size_t bufferBytes, uint32_t flags = RUN_SORTED, bool append = false);
+
+    /* Constructor for a slice starting at record firstRecord */
+    RunWriter(const string& fileName, size_t bufferBytes, uint64_t firstRecord);
+
+    /* A writer owns an open file and a background task, so it is not copied or moved */
+    RunWriter(const RunWriter&) = delete;
+    RunWriter& operator=(const RunWriter&) = delete;
+
+    /* Destructor */
+    ~RunWriter();
+
+    /* Append one record */
+    void write(const T& record)
+    {
+        if (delta)
+        {
+            if (used + MAX_VARINT_BYTES > buffer.size())
+                makeRoom(MAX_VARINT_BYTES);
+            used = DeltaVarint<T>::encode(record, prev, buffer.data() + used) - buffer.data();
+            count++;
+            return;
+        }
+        size_t n = Codec::size(record);
+        if (used + n > buffer.size())
+            makeRoom(n);
+        Codec::encode(record, buffer.data() + used);
+        used += n;
+        count++;
+    }
+
+    /* Append a block of records */
+    void write(const T* records, size_t n);
+
+    /* Return the number of records written so far */
+    uint64_t size() const { return count; }
+
+    /* Flush the buffer, fill in the header and close the file; throw on a write error */
+    void close();
+
+}; /* end of RunWriter class */
+
+
+/*
+ * Type: RunReader
+ * ---------------
+ * This type reads records of type T from a run file through two
+ * buffers of bufferBytes / 2 bytes: one is consumed while the next
+ * chunk of the run is read into the other. A reader may also be
+ * limited to the fixed-size records in positions [first, last), or
+ * read a run that starts further into the file.
+ *
+ * A variable-size record may be cut at the end of a chunk. Each buffer
+ * keeps room in front of its chunk for the start of such a record, so
+ * it is joined with its end without another read.
+ */
+template <typename T>
+class RunReader
+{
+private:
+    typedef RecordCodec<T> Codec;  // for convenience
+
+    string fileName;         // name of the run file, for error messages
+    ifstream inFile;         // the run file
+    RunHeader header;        // header of the run
+    uint64_t headerPos;      // where the header of this run is in the file
+    vector<char> buffer;     // bytes being consumed
+    vector<char> spare;      // bytes being read in the background
+    size_t headroom;         // room in front of a chunk for a cut record
+    size_t chunk;            // bytes read at a time
+    size_t pos, end;         // next and one past the last valid byte in the buffer
+    uint64_t remaining;      // bytes in the file not yet requested
+    uint64_t unread;         // records not yet returned
+    uint64_t wanted;         // records of the run this reader returns
+    bool delta;              // records are delta coded
+    uint64_t prev;           // the last record read, for delta coding
+    launch mode;             // launch::async for large buffers, launch::deferred for small ones
+    future<size_t> pending;  // the background read into spare
+
+    /* Split the buffer bytes into the headroom and the chunk for the header just read, and allocate both buffers */
+    void setBuffers(size_t bufferBytes);
+
+    /* Read the next n bytes of the file into spare */
+    size_t readChunk(size_t n);
+
+    /* Start reading the next chunk into spare */
+    void prefetch();
+
+    /* Switch to the prefetched chunk and start reading the one after it */
+    bool fill();
+
+public:
+    /* Constructor */
+    RunReader(const string& fileName, size_t bufferBytes);
+
+    /* Constructor for the fixed-size records in positions [first, last) */
+    RunReader(const string& fileName, size_t bufferBytes, uint64_t first, uint64_t last);
+
+    /* Constructor for a run whose header is at byte headerPos of the file */
+    RunReader(const string& fileName, size_t bufferBytes, uint64_t headerPos);
+
+    /* Destructor */
+    ~RunReader();
+
+    /* A reader owns an open file and a background task, so it is not copied or moved */
+    RunReader(const RunReader&) = delete;
+    RunReader& operator=(const RunReader&) = delete;
+
+    /* Return the number of records in the whole run */
+    uint64_t size() const { return header.recordCount; }
+
+    /* Test whether the run is delta coded */
+    bool isDelta() const { return delta; }
+
+    /* Test whether the run is flagged as sorted */
+    bool isSorted() const { return (header.flags & RUN_SORTED) != 0; }
+
+    /* Return the byte position just past the run, where the next run of the file starts */
+    uint64_t endPos() const { return headerPos + sizeof(RunHeader) + header.dataBytes; }
+
+    /* Read the next record, return false at the end of the run */
+    bool next(T& record)
+    {
+        if (unread == 0)
+            return false;
+        const char* after;
+        while ((after = delta ? DeltaVarint<T>::decode(buffer.data() + pos, buffer.data() + end, prev, record)
+                              : Codec::decode(buffer.data() + pos, buffer.data() + end, record)) == nullptr)
+            if (!fill())
+                throw runtime_error("run file ends in the middle of a record");
+        pos = after - buffer.data();
+        unread--;
+        return true;
+    }
+
+    /* Read up to n records, return the number read */
+    size_t read(T* records, size_t n);
+
+    /* Wait for the background read and close the file */
+    void close();
+
+}; /* end of RunReader class */
+
+#include "runFile.t"
+
+#endif //RUNFILE_H
@@ -0,0 +1,616 @@
+/**********************************************************************
+ * File name: runFile.t
+ * -----------------------
+ * This file implements all templated functions of the RunWriter and
+ * RunReader classes.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef RUNFILE_T
+#define RUNFILE_T
+
+#include <algorithm>   // copy, min
+#include <chrono>      // chrono::seconds
+
+
+/*******************************************************************************************
+ * Function Name: readRunHeader
+ * ------------------
+ * Purpose: To read the header at the start of an open run file and check it.
+ *
+ * Input Parameters:
+ *          inFile: the run file, positioned at its start.
+ *          fileName: name of the run file, for error messages.
+ *          keyWidth: expected bytes per record, 0 for variable-size records.
+ * Output parameters: none.
+ * Return Value:
+ *          RunHeader: the header of the run.
+ *******************************************************************************************/
+inline RunHeader readRunHeader(ifstream& inFile, const string& fileName, size_t keyWidth)
+{
+    RunHeader header;
+    if (!inFile.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != RUN_MAGIC)
+        throw runtime_error("\"" + fileName + "\" is not a run file");
+    if (header.keyWidth != keyWidth)
+        throw runtime_error("\"" + fileName + "\" holds records of a different width");
+    return header;
+}
+
+
+/*******************************************************************************************
+ * Function Name: createRunFile
+ * ------------------
+ * Purpose: To create a run file of fixed-size records that are then written by slice writers.
+ *
+ * Input Parameters:
+ *          fileName: name of the run file.
+ *          keyWidth: bytes per record.
+ *          recordCount: number of records the slices will write.
+ *          sorted: whether the run is flagged as sorted.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void createRunFile(const string& fileName, size_t keyWidth, uint64_t recordCount, bool sorted)
+{
+    ofstream outFile(fileName, ios::binary | ios::trunc);
+    if (!outFile)
+        throw runtime_error("Unable to create run file \"" + fileName + "\"");
+    RunHeader header = { RUN_MAGIC, static_cast<uint32_t>(keyWidth), recordCount, recordCount * keyWidth,
+                         sorted ? RUN_SORTED : 0, 0 };
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.close();
+    if (!outFile)
+        throw runtime_error("Unable to write run file \"" + fileName + "\"");
+}
+
+
+/*******************************************************************************************
+ * Function Name: readRecordAt
+ * ------------------
+ * Purpose: To read one fixed-size record of an open run file by its position.
+ *
+ * Input Parameters:
+ *          inFile: the run file.
+ *          index: position of the record.
+ * Output parameters: none.
+ * Return Value:
+ *          T: the record.
+ *******************************************************************************************/
+template <typename T>
+T readRecordAt(ifstream& inFile, uint64_t index)
+{
+    const size_t width = RecordCodec<T>::width;
+    vector<char> bytes(width);
+    T record;
+    inFile.seekg(sizeof(RunHeader) + index * width);
+    inFile.read(bytes.data(), width);
+    RecordCodec<T>::decode(bytes.data(), bytes.data() + width, record);
+    return record;
+}
+
+
+/*******************************************************************************************
+ * Function Name: lowerBoundInRun
+ * ------------------
+ * Purpose: To binary search a sorted run file of fixed-size records without reading all of it.
+ *
+ * Input Parameters:
+ *          inFile: the run file.
+ *          recordCount: number of records in the run.
+ *          key: the record to search for.
+ *          less: the "less than" order the run is sorted by.
+ * Output parameters: none.
+ * Return Value:
+ *          uint64_t: the position of the first record not less than key.
+ *******************************************************************************************/
+template <typename T, typename Less>
+uint64_t lowerBoundInRun(ifstream& inFile, uint64_t recordCount, const T& key, const Less& less)
+{
+    uint64_t low = 0, high = recordCount;
+    while (low < high)
+    {
+        uint64_t mid = low + (high - low) / 2;
+        if (less(readRecordAt<T>(inFile, mid), key))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunWriter
+ * ------------------
+ * Purpose: To create a run file and reserve room for its header.
+ *
+ * Input Parameters:
+ *          fileName: name of the run file.
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ *          flags: header flags of the run, RUN_SORTED and RUN_DELTA.
+ *          append: add the run after the runs already in the file.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+RunWriter<T>::RunWriter(const string& fileName, size_t bufferBytes, uint32_t flags, bool append)
+    : fileName(fileName), buffer(bufferBytes > 1 ? bufferBytes / 2 : 1), spare(buffer.size()),
+      used(0), count(0), bytes(0), flags(flags), delta((flags & RUN_DELTA) != 0), prev(0), slice(false),
+      mode(buffer.size() >= ASYNC_IO_BYTES ? launch::async : launch::deferred)
+{
+    if (delta && !DeltaVarint<T>::supported)
+        throw runtime_error("Only integer records can be delta coded");
+    outFile.rdbuf()->pubsetbuf(nullptr, 0);   // our own buffers are the only ones
+    if (append)
+        outFile.open(fileName, ios::binary | ios::in | ios::out | ios::ate);
+    if (!outFile.is_open())
+        outFile.open(fileName, ios::binary | ios::trunc);
+    if (!outFile)
+        throw runtime_error("Unable to create run file \"" + fileName + "\"");
+    headerPos = outFile.tellp();
+
+    RunHeader header = { RUN_MAGIC, Codec::width, 0, 0, flags, 0 };
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunWriter
+ * ------------------
+ * Purpose: To open a slice of a run file made by createRunFile.
+ *
+ * Input Parameters:
+ *          fileName: name of the run file.
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ *          firstRecord: position of the first record of the slice.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+RunWriter<T>::RunWriter(const string& fileName, size_t bufferBytes, uint64_t firstRecord)
+    : fileName(fileName), buffer(bufferBytes > 1 ? bufferBytes / 2 : 1), spare(buffer.size()),
+      used(0), count(0), bytes(0), flags(0), delta(false), prev(0), slice(true), headerPos(0),
+      mode(buffer.size() >= ASYNC_IO_BYTES ? launch::async : launch::deferred)
+{
+    if (Codec::width == 0)
+        throw runtime_error("Only fixed-size records can be written in slices");
+    outFile.rdbuf()->pubsetbuf(nullptr, 0);
+    outFile.open(fileName, ios::binary | ios::in | ios::out);   // keep what the other slices write
+    if (!outFile)
+        throw runtime_error("Unable to open run file \"" + fileName + "\"");
+    outFile.seekp(sizeof(RunHeader) + firstRecord * Codec::width);
+}
+
+
+/*******************************************************************************************
+ * Destructor: RunWriter
+ * ------------------
+ * Purpose: To close a run file the caller did not close, as when an exception is on its way
+ *          out. A write error found here is dropped, so callers that keep the run call close.
+ *******************************************************************************************/
+template <typename T>
+RunWriter<T>::~RunWriter()
+{
+    if (outFile.is_open())
+    {
+        try {
+            close();
+        }
+        catch (...) {
+        }
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: writeChunk / wait / flush / makeRoom
+ * ------------------
+ * Purpose: To write the spare buffer in the background, to wait for that write,
+ *          to hand a full buffer to the background while filling the other one,
+ *          and to make sure the buffer can take the next record. A failed background
+ *          write is carried by its future and thrown by wait, when the buffers are
+ *          next swapped or the run is closed.
+ *
+ * Input Parameters:
+ *          n: number of bytes of spare to write, or of the next record.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the number of bytes written.
+ *******************************************************************************************/
+template <typename T>
+size_t RunWriter<T>::writeChunk(size_t n)
+{
+    outFile.write(spare.data(), n);
+    if (!outFile)
+        throw runtime_error("Unable to write run file \"" + fileName + "\"");
+    sortStats().addBytesWritten(n);
+    return n;
+}
+
+template <typename T>
+void RunWriter<T>::wait()
+{
+    if (pending.valid())
+    {
+        IoTimer timer;
+        pending.get();
+    }
+}
+
+template <typename T>
+void RunWriter<T>::flush()
+{
+    wait();                               // spare must be free before it takes the full buffer
+    if (used == 0)
+        return;
+    buffer.swap(spare);
+    pending = async(mode, &RunWriter<T>::writeChunk, this, used);
+    bytes += used;
+    used = 0;
+}
+
+template <typename T>
+void RunWriter<T>::makeRoom(size_t n)
+{
+    flush();
+    if (n > buffer.size())                // a record larger than a whole buffer
+        buffer.resize(n);
+}
+
+
+/*******************************************************************************************
+ * Function Name: write
+ * ------------------
+ * Purpose: To append a block of records. Blocks of records stored as their
+ *          bytes that do not fit in the buffer are written straight from the
+ *          caller's memory.
+ *
+ * Input Parameters:
+ *          records: pointer to the block of records.
+ *          n: number of records in the block.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void RunWriter<T>::write(const T* records, size_t n)
+{
+    if (delta || Codec::width != sizeof(T))   // records that are encoded go one by one
+    {
+        for (size_t i = 0; i < n; i++)
+            write(records[i]);
+        return;
+    }
+
+    size_t size = n * sizeof(T);
+    if (used + size < buffer.size())      // small block: just buffer it
+    {
+        memcpy(buffer.data() + used, records, size);
+        used += size;
+        count += n;
+        return;
+    }
+    flush();                              // large block: keep the order, then write it directly
+    wait();
+    {
+        IoTimer timer;
+        outFile.write(reinterpret_cast<const char*>(records), size);
+    }
+    if (!outFile)
+        throw runtime_error("Unable to write run file \"" + fileName + "\"");
+    sortStats().addBytesWritten(size);
+    bytes += size;
+    count += n;
+}
+
+
+/*******************************************************************************************
+ * Function Name: close
+ * ------------------
+ * Purpose: To write the last records, fill in the counts of the header and count the records
+ *          written in the statistics. A write error, such as a full disk, is thrown here
+ *          rather than left to show as a short run when the run is read.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void RunWriter<T>::close()
+{
+    try {
+        flush();
+        wait();
+    }
+    catch (...) {
+        outFile.close();                      // the run is lost; the destructor must not finish it
+        throw;
+    }
+    if (!slice)
+    {
+        RunHeader header = { RUN_MAGIC, Codec::width, count, bytes, flags, 0 };
+        outFile.seekp(headerPos);
+        outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    outFile.close();
+    if (!outFile)
+        throw runtime_error("Unable to write run file \"" + fileName + "\"");
+    sortStats().addRecordsWritten(count);
+}
+
+
+/*******************************************************************************************
+ * Function Name: setBuffers
+ * ------------------
+ * Purpose: To size the two buffers of a reader. Fixed-size records are read in
+ *          chunks of whole records and need no headroom; variable-size and delta
+ *          coded records give a quarter of the buffer bytes to the headroom of
+ *          each buffer.
+ *
+ * Input Parameters:
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void RunReader<T>::setBuffers(size_t bufferBytes)
+{
+    size_t half = (bufferBytes > 1) ? bufferBytes / 2 : 1;
+    delta = (header.flags & RUN_DELTA) != 0;
+    prev = 0;
+    if (Codec::width > 0 && !delta)
+    {
+        headroom = 0;
+        chunk = (half > Codec::width) ? half - half % Codec::width : Codec::width;
+    }
+    else
+    {
+        headroom = half / 2;
+        chunk = (half > headroom) ? half - headroom : 1;
+    }
+    buffer.resize(headroom + chunk);
+    spare.resize(headroom + chunk);
+    pos = end = headroom;
+    mode = (half >= ASYNC_IO_BYTES) ? launch::async : launch::deferred;
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunReader
+ * ------------------
+ * Purpose: To open a run file, check its header and start reading the first chunk.
+ *
+ * Input Parameters:
+ *          fileName: name of the run file.
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+RunReader<T>::RunReader(const string& fileName, size_t bufferBytes)
+    : fileName(fileName), headerPos(0)
+{
+    inFile.rdbuf()->pubsetbuf(nullptr, 0);    // our own buffers are the only ones
+    inFile.open(fileName, ios::binary);
+    header = readRunHeader(inFile, fileName, Codec::width);
+    setBuffers(bufferBytes);
+    remaining = header.dataBytes;
+    unread = wanted = header.recordCount;
+    prefetch();
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunReader
+ * ------------------
+ * Purpose: To open a run file of fixed-size records for the records in positions [first, last) only.
+ *
+ * Input Parameters:
+ *          fileName: name of the run file.
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ *          first, last: the positions to read.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+RunReader<T>::RunReader(const string& fileName, size_t bufferBytes, uint64_t first, uint64_t last)
+    : fileName(fileName), headerPos(0)
+{
+    if (Codec::width == 0)
+        throw runtime_error("Only fixed-size records can be read in slices");
+    inFile.rdbuf()->pubsetbuf(nullptr, 0);
+    inFile.open(fileName, ios::binary);
+    header = readRunHeader(inFile, fileName, Codec::width);
+    setBuffers(bufferBytes);
+    if (delta)
+        throw runtime_error("A delta coded run can only be read from its start");
+    if (last > header.recordCount)
+        last = header.recordCount;
+    unread = wanted = (first < last) ? last - first : 0;
+    remaining = unread * Codec::width;
+    inFile.seekg(sizeof(RunHeader) + first * Codec::width);
+    prefetch();
+}
+
+
+/*******************************************************************************************
+ * Constructor: RunReader
+ * ------------------
+ * Purpose: To open a run that starts further into a file holding several runs.
+ *
+ * Input Parameters:
+ *          fileName: name of the file.
+ *          bufferBytes: number of bytes buffered, split over the two buffers.
+ *          headerPos: byte position of the run's header, the endPos() of the run before it.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+RunReader<T>::RunReader(const string& fileName, size_t bufferBytes, uint64_t headerPos)
+    : fileName(fileName), headerPos(headerPos)
+{
+    inFile.rdbuf()->pubsetbuf(nullptr, 0);
+    inFile.open(fileName, ios::binary);
+    inFile.seekg(headerPos);
+    header = readRunHeader(inFile, fileName, Codec::width);
+    setBuffers(bufferBytes);
+    remaining = header.dataBytes;
+    unread = wanted = header.recordCount;
+    prefetch();
+}
+
+
+/*******************************************************************************************
+ * Destructor: RunReader
+ * ------------------
+ * Purpose: To wait for a background read before the buffers go away.
+ *******************************************************************************************/
+template <typename T>
+RunReader<T>::~RunReader()
+{
+    close();
+}
+
+
+/*******************************************************************************************
+ * Function Name: readChunk / prefetch
+ * ------------------
+ * Purpose: To read the next chunk of the run into spare, after its headroom, in the background.
+ *          A failed read is carried by the future and thrown by fill, so a run cut short by
+ *          an I/O error is not taken for a complete one.
+ *
+ * Input Parameters:
+ *          n: number of bytes to read.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the number of bytes read.
+ *******************************************************************************************/
+template <typename T>
+size_t RunReader<T>::readChunk(size_t n)
+{
+    inFile.read(spare.data() + headroom, n);
+    if (inFile.bad() || static_cast<size_t>(inFile.gcount()) != n)
+        throw runtime_error("Unable to read run file \"" + fileName + "\"");
+    sortStats().addBytesRead(n);
+    return n;
+}
+
+template <typename T>
+void RunReader<T>::prefetch()
+{
+    size_t n = static_cast<size_t>(min<uint64_t>(remaining, chunk));
+    if (n == 0)
+        return;
+    remaining -= n;
+    pending = async(mode, &RunReader<T>::readChunk, this, n);
+}
+
+
+/*******************************************************************************************
+ * Function Name: fill
+ * ------------------
+ * Purpose: To switch to the prefetched chunk once the current one is consumed.
+ *          The start of a record cut at the end of the current chunk is moved
+ *          in front of the new chunk, into its headroom or, for a record longer
+ *          than the headroom, into a larger buffer.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: false if the run has no more bytes.
+ *******************************************************************************************/
+template <typename T>
+bool RunReader<T>::fill()
+{
+    if (!pending.valid())
+        return false;
+    size_t n;
+    {
+        IoTimer timer;
+        n = pending.get();
+    }
+    if (n == 0)
+        return false;
+
+    size_t leftover = end - pos;
+    if (leftover <= headroom)
+    {
+        copy(buffer.begin() + pos, buffer.begin() + end, spare.begin() + (headroom - leftover));
+        buffer.swap(spare);
+        pos = headroom - leftover;
+        end = headroom + n;
+    }
+    else
+    {
+        vector<char> joined(max(leftover + n, headroom + chunk));
+        copy(buffer.begin() + pos, buffer.begin() + end, joined.begin());
+        copy(spare.begin() + headroom, spare.begin() + (headroom + n), joined.begin() + leftover);
+        buffer.swap(joined);
+        pos = 0;
+        end = leftover + n;
+    }
+    prefetch();
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: read
+ * ------------------
+ * Purpose: To read a block of records chunk by chunk.
+ *
+ * Input Parameters:
+ *          records: where to store the records.
+ *          n: max number of records to read.
+ * Output parameters:
+ *          records: the records read.
+ * Return Value:
+ *          size_t: the number of records read, less than n at the end of the run.
+ *******************************************************************************************/
+template <typename T>
+size_t RunReader<T>::read(T* records, size_t n)
+{
+    size_t got = 0;
+    if (delta || Codec::width != sizeof(T))   // records that are decoded go one by one
+    {
+        while (got < n && next(records[got]))
+            got++;
+        return got;
+    }
+
+    while (got < n && unread > 0 && (pos < end || fill()))
+    {
+        size_t take = min<uint64_t>(min(n - got, (end - pos) / sizeof(T)), unread);
+        memcpy(records + got, buffer.data() + pos, take * sizeof(T));
+        pos += take * sizeof(T);
+        got += take;
+        unread -= take;
+    }
+    return got;
+}
+
+
+/*******************************************************************************************
+ * Function Name: close
+ * ------------------
+ * Purpose: To wait for a background read, close the run file and count the records read in
+ *          the statistics.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename T>
+void RunReader<T>::close()
+{
+    // A background read must finish before the file closes; a deferred one has not started and is dropped.
+    if (pending.valid() && pending.wait_for(chrono::seconds(0)) != future_status::deferred)
+        pending.wait();
+    inFile.close();
+    sortStats().addRecordsRead(wanted - unread);
+    wanted = unread;
+}
+
+#endif //RUNFILE_T
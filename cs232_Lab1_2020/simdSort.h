@@ -0,0 +1,360 @@
+/**********************************************************************
+ * File name: simdSort.h
+ * -----------------------
+ * This file defines sorting networks in SIMD registers for blocks of
+ * 8 to 64 ints or floats, the base case of the quicksort and mergesort
+ * templates of sort_algorithms.t.
+ *
+ * A block is padded with the largest key to a power of 2 registers,
+ * and sorted by a bitonic network: every step compares whole registers
+ * lane by lane with min and max, or, for elements in the same register,
+ * the register with a permutation of itself, so a block of 64 ints
+ * takes 21 steps of 8 registers and no branch at all. AVX2 registers
+ * hold 8 keys; on CPUs without AVX2 the same network runs on SSE4.1
+ * registers of 4 keys. Which one is used is decided once, when the
+ * first block is sorted, by what the CPU supports; without either, or
+ * off x86, the functions sort nothing and the caller falls back on
+ * insertion sort.
+ *
+ * Floats are sorted as ints whose order is that of the floats: the
+ * bits of a negative float but its sign are flipped. -0.0 comes out
+ * before +0.0, which operator< holds equal, so the network is only
+ * used on floats by sorts that are not stable.
+ *
+ * The networks apply only to sorts in ascending order by std::less;
+ * for any other element type or comparator simdSort returns false.
+ * Like taskPool.h this header does not use the std namespace.
+ *
+ * This file defines the
+ *      simdSort function:        sorts a small block of ints or floats, if it can.
+ *      simdStableSort function:  the same, for stable sorts: ints only.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef SIMDSORT_H
+#define SIMDSORT_H
+
+#include <climits>     // INT_MAX padding
+#include <cstring>     // memcpy float bits
+#include <functional>  // std::less
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMDSORT_X86
+#include <immintrin.h>
+#define SIMDSORT_AVX2 __attribute__((target("avx2")))
+#define SIMDSORT_SSE41 __attribute__((target("sse4.1")))
+#endif
+
+const int SIMD_SORT_MIN = 8;       // blocks smaller than this are left to insertion sort
+const int SIMD_SORT_MAX = 64;      // the largest block a network sorts
+
+enum SimdLevel { SIMD_NONE, SIMD_SSE41, SIMD_AVX2 };
+
+
+#ifdef SIMDSORT_X86
+
+/*
+ * Type: Avx2Lanes / Sse41Lanes
+ * ----------------------------
+ * The operations of the network on registers of 8 or 4 int keys.
+ * minMax leaves the lane by lane minimum of two registers in the first
+ * and the maximum in the second; minMaxLanes compares every lane t of
+ * one register with lane t ^ partner and keeps the maximum in the
+ * lanes with bit high set.
+ */
+struct Avx2Lanes
+{
+    typedef __m256i Vec;
+    static const int width = 8;
+
+    SIMDSORT_AVX2 static void load(Vec& v, const int* keys)
+    {
+        v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+    }
+
+    SIMDSORT_AVX2 static void store(int* keys, const Vec& v)
+    {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys), v);
+    }
+
+    SIMDSORT_AVX2 static void minMax(Vec& a, Vec& b)
+    {
+        Vec low = _mm256_min_epi32(a, b);
+        b = _mm256_max_epi32(a, b);
+        a = low;
+    }
+
+    SIMDSORT_AVX2 static void reverse(Vec& v)
+    {
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    }
+
+    SIMDSORT_AVX2 static void minMaxLanes(Vec& v, int partner, int high)
+    {
+        Vec lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        Vec other = _mm256_permutevar8x32_epi32(v, _mm256_xor_si256(lanes, _mm256_set1_epi32(partner)));
+        Vec takeMax = _mm256_cmpeq_epi32(_mm256_and_si256(lanes, _mm256_set1_epi32(high)), _mm256_set1_epi32(high));
+        v = _mm256_blendv_epi8(_mm256_min_epi32(v, other), _mm256_max_epi32(v, other), takeMax);
+    }
+};
+
+struct Sse41Lanes
+{
+    typedef __m128i Vec;
+    static const int width = 4;
+
+    SIMDSORT_SSE41 static void load(Vec& v, const int* keys)
+    {
+        v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+    }
+
+    SIMDSORT_SSE41 static void store(int* keys, const Vec& v)
+    {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(keys), v);
+    }
+
+    SIMDSORT_SSE41 static void minMax(Vec& a, Vec& b)
+    {
+        Vec low = _mm_min_epi32(a, b);
+        b = _mm_max_epi32(a, b);
+        a = low;
+    }
+
+    SIMDSORT_SSE41 static void reverse(Vec& v)
+    {
+        v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+
+    SIMDSORT_SSE41 static void minMaxLanes(Vec& v, int partner, int high)
+    {
+        // lane t takes the 4 bytes of lane t ^ partner
+        Vec bytes = _mm_setr_epi32(((0 ^ partner) * 4) * 0x01010101 + 0x03020100,
+                                   ((1 ^ partner) * 4) * 0x01010101 + 0x03020100,
+                                   ((2 ^ partner) * 4) * 0x01010101 + 0x03020100,
+                                   ((3 ^ partner) * 4) * 0x01010101 + 0x03020100);
+        Vec other = _mm_shuffle_epi8(v, bytes);
+        Vec takeMax = _mm_setr_epi32((0 & high) ? -1 : 0, (1 & high) ? -1 : 0, (2 & high) ? -1 : 0, (3 & high) ? -1 : 0);
+        v = _mm_blendv_epi8(_mm_min_epi32(v, other), _mm_max_epi32(v, other), takeMax);
+    }
+};
+
+
+/*******************************************************************************************
+ * Function Name: bitonicSortRegisters
+ * ------------------
+ * Purpose: To sort the keys of regs registers, a power of 2, in ascending order, the
+ *          lanes of register 0 first. For every block size k from 2 up, each key is
+ *          compared with its mirror image in its block, which merges two sorted halves
+ *          into a bitonic block, and then with the keys k/4, k/8, ..., 1 away. Keys a
+ *          register or more apart are compared register by register, the others by
+ *          permuting the lanes of one register.
+ *
+ * Input Parameters:
+ *          v: the registers.
+ *          regs: # of registers.
+ * Output parameters:
+ *          v: the sorted registers.
+ * Return Value: none.
+ *******************************************************************************************/
+template <typename Lanes>
+inline void bitonicSortRegisters(typename Lanes::Vec* v, int regs)
+{
+    const int width = Lanes::width;
+    for (int k = 2; k <= width * regs; k *= 2)
+    {
+        if (k <= width)
+            for (int r = 0; r < regs; r++)
+                Lanes::minMaxLanes(v[r], k - 1, k / 2);
+        else
+        {
+            int span = k / width;                    // registers per block
+            for (int b = 0; b < regs; b += span)
+                for (int i = 0; i < span / 2; i++)
+                {
+                    Lanes::reverse(v[b + span - 1 - i]);
+                    Lanes::minMax(v[b + i], v[b + span - 1 - i]);
+                    Lanes::reverse(v[b + span - 1 - i]);
+                }
+        }
+
+        for (int j = k / 4; j >= 1; j /= 2)
+        {
+            if (j >= width)
+            {
+                int d = j / width;                   // registers apart
+                for (int r = 0; r < regs; r++)
+                    if ((r & d) == 0)
+                        Lanes::minMax(v[r], v[r + d]);
+            }
+            else
+                for (int r = 0; r < regs; r++)
+                    Lanes::minMaxLanes(v[r], j, j);
+        }
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: sortKeysAvx2 / sortKeysSse41
+ * ------------------
+ * Purpose: To sort regs registers of keys with AVX2 or SSE4.1. Every function the network
+ *          calls is inlined into these, so it runs without a call.
+ *
+ * Input Parameters:
+ *          keys: regs * 8 or regs * 4 keys.
+ *          regs: # of registers, a power of 2.
+ * Output parameters:
+ *          keys: the sorted keys.
+ * Return Value: none.
+ *******************************************************************************************/
+__attribute__((target("avx2"), flatten)) inline void sortKeysAvx2(int* keys, int regs)
+{
+    Avx2Lanes::Vec v[SIMD_SORT_MAX / Avx2Lanes::width];
+    for (int r = 0; r < regs; r++)
+        Avx2Lanes::load(v[r], keys + r * Avx2Lanes::width);
+    bitonicSortRegisters<Avx2Lanes>(v, regs);
+    for (int r = 0; r < regs; r++)
+        Avx2Lanes::store(keys + r * Avx2Lanes::width, v[r]);
+}
+
+__attribute__((target("sse4.1"), flatten)) inline void sortKeysSse41(int* keys, int regs)
+{
+    Sse41Lanes::Vec v[SIMD_SORT_MAX / Sse41Lanes::width];
+    for (int r = 0; r < regs; r++)
+        Sse41Lanes::load(v[r], keys + r * Sse41Lanes::width);
+    bitonicSortRegisters<Sse41Lanes>(v, regs);
+    for (int r = 0; r < regs; r++)
+        Sse41Lanes::store(keys + r * Sse41Lanes::width, v[r]);
+}
+
+#endif //SIMDSORT_X86
+
+
+/*******************************************************************************************
+ * Function Name: simdLevel
+ * ------------------
+ * Purpose: To find, the first time it is called, the widest registers the CPU can sort in.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          SimdLevel: SIMD_AVX2, SIMD_SSE41 or SIMD_NONE.
+ *******************************************************************************************/
+inline SimdLevel simdLevel()
+{
+#ifdef SIMDSORT_X86
+    static const SimdLevel level = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SIMD_AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return SIMD_SSE41;
+        return SIMD_NONE;
+    }();
+    return level;
+#else
+    return SIMD_NONE;
+#endif
+}
+
+
+/*******************************************************************************************
+ * Function Name: sortIntKeys
+ * ------------------
+ * Purpose: To sort a block of SIMD_SORT_MIN to SIMD_SORT_MAX ints with a network at a
+ *          given level: the block is copied and padded with INT_MAX to a power of 2
+ *          registers, sorted, and its first n keys copied back.
+ *
+ * Input Parameters:
+ *          keys: the block.
+ *          n: # of keys in it.
+ *          level: the registers to sort in.
+ * Output parameters:
+ *          keys: the sorted block.
+ * Return Value:
+ *          bool: false, leaving the block as it was, if n is out of range or level is SIMD_NONE.
+ *******************************************************************************************/
+inline bool sortIntKeys(int* keys, int n, SimdLevel level)
+{
+    if (n < SIMD_SORT_MIN || n > SIMD_SORT_MAX || level == SIMD_NONE)
+        return false;
+#ifdef SIMDSORT_X86
+    int width = (level == SIMD_AVX2) ? Avx2Lanes::width : Sse41Lanes::width;
+    int regs = 1;
+    while (regs * width < n)
+        regs *= 2;
+
+    int padded[SIMD_SORT_MAX];
+    memcpy(padded, keys, n * sizeof(int));
+    for (int i = n; i < regs * width; i++)
+        padded[i] = INT_MAX;
+    if (level == SIMD_AVX2)
+        sortKeysAvx2(padded, regs);
+    else
+        sortKeysSse41(padded, regs);
+    memcpy(keys, padded, n * sizeof(int));
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+/*******************************************************************************************
+ * Function Name: simdSort / simdStableSort
+ * ------------------
+ * Purpose: To sort a block of SIMD_SORT_MIN to SIMD_SORT_MAX ints, or floats for simdSort,
+ *          by std::less with a network. For any other block they do nothing, so a sort
+ *          template may call them on any range and sort it another way if they return
+ *          false. Floats are flipped into ints that sort in the same order and back.
+ *
+ * Input Parameters:
+ *          arrayptr: the block.
+ *          n: # of elements in it.
+ *          cmp: the comparator, which picks the overload.
+ * Output parameters:
+ *          arrayptr: the sorted block.
+ * Return Value:
+ *          bool: true if the block was sorted.
+ *******************************************************************************************/
+template <typename T, typename Compare>
+inline bool simdSort(T*, int, Compare)
+{
+    return false;
+}
+
+inline bool simdSort(int* arrayptr, int n, std::less<int>)
+{
+    return sortIntKeys(arrayptr, n, simdLevel());
+}
+
+inline bool simdSort(float* arrayptr, int n, std::less<float>)
+{
+    if (n < SIMD_SORT_MIN || n > SIMD_SORT_MAX || simdLevel() == SIMD_NONE)
+        return false;
+    int keys[SIMD_SORT_MAX];
+    memcpy(keys, arrayptr, n * sizeof(int));
+    for (int i = 0; i < n; i++)
+        keys[i] ^= (keys[i] >> 31) & INT_MAX;      // negative floats: larger magnitude, smaller key
+    sortIntKeys(keys, n, simdLevel());
+    for (int i = 0; i < n; i++)
+        keys[i] ^= (keys[i] >> 31) & INT_MAX;
+    memcpy(arrayptr, keys, n * sizeof(int));
+    return true;
+}
+
+template <typename T, typename Compare>
+inline bool simdStableSort(T*, int, Compare)
+{
+    return false;
+}
+
+inline bool simdStableSort(int* arrayptr, int n, std::less<int> cmp)
+{
+    return simdSort(arrayptr, n, cmp);
+}
+
+#endif //SIMDSORT_H
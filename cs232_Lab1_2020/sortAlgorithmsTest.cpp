@@ -0,0 +1,286 @@
+// Jian Zhong
+// CS232 Lab1
+// 10/17/2026
+// sortAlgorithmsTest.cpp
+//
+// Tests of the sorts of sort_algorithms.t: every sort, on ints, floats and strings, of
+// random, sorted, reversed, organ-pipe and few-unique inputs, is checked against
+// std::stable_sort. The parallel sorts are run on 1, 2, 3 and 8 threads. The stable
+// sorts must also keep equal keys in input order, and the parallel sorts must hand a
+// comparison that throws back to the caller.
+//
+//     g++ -std=c++17 -O2 -pthread -o sortAlgorithmsTest sortAlgorithmsTest.cpp
+//
+// Build with -fsanitize=thread, or with -fsanitize=address,undefined, to run the same
+// tests under ThreadSanitizer or AddressSanitizer (-O1 -g keeps them fast enough).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+#include "sort_algorithms.t"
+
+using namespace std;
+
+const int SIZES[] = { 0, 1, 2, 5, 33, 1000, 70000 };    // 70000 is several parallel grains
+const int THREADS[] = { 1, 2, 3, 8 };
+const char* const PATTERNS[] = { "random", "sorted", "reversed", "organ-pipe", "few-unique" };
+const char* const SORTS[] = { "pdqSort", "heapSort", "msSort", "mergesort1", "bottomUpMergeSort",
+                              "parallelMsSort", "parallelPdqSort" };
+
+/*
+ * Type: Item
+ * ----------
+ * A key and the position it had in the input, to see whether a sort is stable.
+ * Its own swap keeps std::iter_swap from choosing between std::swap and the
+ * swap of sort_algorithms.t.
+ */
+struct Item
+{
+    int key;
+    int index;
+
+    friend void swap(Item& a, Item& b)
+    {
+        std::swap(a.key, b.key);
+        std::swap(a.index, b.index);
+    }
+};
+
+/*
+ * Type: ItemLess
+ * --------------
+ * Orders items by their keys only.
+ */
+struct ItemLess
+{
+    bool operator()(const Item& a, const Item& b) const { return a.key < b.key; }
+};
+
+/*
+ * Type: ThrowingLess
+ * ------------------
+ * Orders ints, but throws once the shared count of comparisons left runs out.
+ */
+struct ThrowingLess
+{
+    atomic<long>* left;     // # of comparisons before one throws, shared by every copy
+    bool operator()(int a, int b) const
+    {
+        if (left->fetch_sub(1) == 1)
+            throw runtime_error("comparison failed");
+        return a < b;
+    }
+};
+
+// Function Prototypes:
+vector<int> makeKeys(const string& pattern, int size, unsigned seed);
+void makeValue(int key, int& value);
+void makeValue(int key, float& value);
+void makeValue(int key, string& value);
+bool isParallel(const string& sort);
+bool isStable(const string& sort);
+template <typename T, typename Compare>
+void runSort(const string& sort, T* arrayptr, int arraySize, Compare cmp, int threadNum);
+template <typename T>
+int testValues(const string& typeName);
+int testStability();
+int testExceptions();
+bool check(bool passed, const string& what);
+
+int checkNum = 0;       // # of checks made
+
+// Main Function:
+int main() {
+    int failed = testValues<int>("int") + testValues<float>("float") + testValues<string>("string")
+               + testStability() + testExceptions();
+
+    cout << checkNum - failed << " of " << checkNum << " checks passed" << endl;
+    return (failed == 0) ? 0 : 1;
+}  /* end of main */
+
+
+/// Make the keys of one input pattern.
+/// @param pattern random, sorted, reversed, organ-pipe or few-unique
+/// @param size # of keys
+/// @param seed seed of the random keys
+/// @return the keys
+vector<int> makeKeys(const string& pattern, int size, unsigned seed)
+{
+    mt19937 random(seed);
+    vector<int> keys(size);
+    for (int i = 0; i < size; i++)
+    {
+        if (pattern == "random")
+            keys[i] = static_cast<int>(random() % 1000000) - 500000;
+        else if (pattern == "sorted")
+            keys[i] = i;
+        else if (pattern == "reversed")
+            keys[i] = size - i;
+        else if (pattern == "organ-pipe")
+            keys[i] = (i < size / 2) ? i : size - i;
+        else
+            keys[i] = static_cast<int>(random() % 10);
+    }
+    return keys;
+}
+
+/// Make the value of a key, in each type the sorts are tested on.
+/// @param key the key
+/// @param value set to the value of the key
+void makeValue(int key, int& value)
+{
+    value = key;
+}
+
+void makeValue(int key, float& value)
+{
+    value = key * 0.25f;
+}
+
+void makeValue(int key, string& value)
+{
+    value = "v" + to_string(key);
+}
+
+/// Tell whether a sort takes a number of threads.
+/// @param sort name of the sort
+/// @return true for the parallel sorts
+bool isParallel(const string& sort)
+{
+    return sort == "parallelMsSort" || sort == "parallelPdqSort";
+}
+
+/// Tell whether a sort keeps equal elements in input order.
+/// @param sort name of the sort
+/// @return true for the merge sorts but mergesort1
+bool isStable(const string& sort)
+{
+    return sort == "msSort" || sort == "bottomUpMergeSort" || sort == "parallelMsSort";
+}
+
+/// Sort an array with one of the sorts of sort_algorithms.t.
+/// @param sort name of the sort
+/// @param arrayptr the array
+/// @param arraySize # of elements in the array
+/// @param cmp true if the first element comes before the second
+/// @param threadNum # of threads of a parallel sort
+template <typename T, typename Compare>
+void runSort(const string& sort, T* arrayptr, int arraySize, Compare cmp, int threadNum)
+{
+    if (sort == "pdqSort")
+        pdqSort(arrayptr, arraySize, cmp);
+    else if (sort == "heapSort")
+        heapSort(arrayptr, arraySize, cmp);
+    else if (sort == "msSort")
+        msSort(arrayptr, arraySize, cmp);
+    else if (sort == "mergesort1")
+        mergesort1(arrayptr, arraySize, cmp);
+    else if (sort == "bottomUpMergeSort")
+        bottomUpMergeSort(arrayptr, arraySize, cmp);
+    else if (sort == "parallelMsSort")
+        parallelMsSort(arrayptr, arraySize, cmp, threadNum);
+    else
+        parallelPdqSort(arrayptr, arraySize, cmp, threadNum);
+}
+
+/// Check every sort, on every input pattern and size, against std::stable_sort.
+/// @param typeName name of the type T, for the report
+/// @return the # of failed checks
+template <typename T>
+int testValues(const string& typeName)
+{
+    int failed = 0;
+    for (const string sort : SORTS)
+        for (const string pattern : PATTERNS)
+            for (int size : SIZES)
+                for (int threadNum : THREADS)
+                {
+                    if (!isParallel(sort) && threadNum != 1)
+                        continue;
+                    vector<int> keys = makeKeys(pattern, size, size + threadNum);
+                    vector<T> values(size);
+                    for (int i = 0; i < size; i++)
+                        makeValue(keys[i], values[i]);
+                    vector<T> expected = values;
+                    stable_sort(expected.begin(), expected.end());
+
+                    runSort(sort, values.data(), size, less<T>(), threadNum);
+                    failed += !check(values == expected, sort + " of " + to_string(size) + " " + pattern + " "
+                                     + typeName + "s on " + to_string(threadNum) + " thread(s)");
+                }
+    return failed;
+}
+
+/// Check that the stable sorts keep items with equal keys in input order.
+/// @return the # of failed checks
+int testStability()
+{
+    int failed = 0;
+    for (const string sort : SORTS)
+        for (int size : SIZES)
+            for (int threadNum : THREADS)
+            {
+                if (!isStable(sort) || (!isParallel(sort) && threadNum != 1))
+                    continue;
+                vector<int> keys = makeKeys("few-unique", size, size);
+                vector<Item> items(size);
+                for (int i = 0; i < size; i++)
+                    items[i] = Item{ keys[i], i };
+                vector<Item> expected = items;
+                stable_sort(expected.begin(), expected.end(), ItemLess());
+
+                runSort(sort, items.data(), size, ItemLess(), threadNum);
+                bool same = equal(items.begin(), items.end(), expected.begin(),
+                                  [](const Item& a, const Item& b) { return a.key == b.key && a.index == b.index; });
+                failed += !check(same, sort + " keeps the order of equal keys in " + to_string(size)
+                                 + " items on " + to_string(threadNum) + " thread(s)");
+            }
+    return failed;
+}
+
+/// Check that a comparison that throws, early or late in a sort, reaches the caller of
+/// a parallel sort instead of ending the program.
+/// @return the # of failed checks
+int testExceptions()
+{
+    const long afterComparisons[] = { 1, 1000, 200000 };
+    const int size = 70000;
+
+    int failed = 0;
+    for (const string sort : SORTS)
+        for (int threadNum : THREADS)
+            for (long after : afterComparisons)
+            {
+                if (!isParallel(sort) || threadNum == 1)
+                    continue;
+                vector<int> keys = makeKeys("random", size, threadNum);
+                atomic<long> left(after);
+                bool thrown = false;
+                try {
+                    runSort(sort, keys.data(), size, ThrowingLess{ &left }, threadNum);
+                }
+                catch (const runtime_error& error) {
+                    thrown = string(error.what()) == "comparison failed";
+                }
+                failed += !check(thrown, sort + " on " + to_string(threadNum) + " thread(s) throws the error of comparison "
+                                 + to_string(after));
+            }
+    return failed;
+}
+
+/// Count a check, and report it if it failed.
+/// @param passed whether the check passed
+/// @param what what was checked
+/// @return passed
+bool check(bool passed, const string& what)
+{
+    checkNum++;
+    if (!passed)
+        cout << "FAILED: " << what << endl;
+    return passed;
+}
@@ -0,0 +1,355 @@
+// Jian Zhong
+// CS232 Lab1
+// 10/17/2026
+// sortBenchmark.cpp
+//
+// Benchmark of the external sort: generates files of integers with several
+// distributions and sizes, sorts every file under several memory budgets,
+// and reports the throughput, runs, merge passes and peak memory of every sort.
+//
+//     sortBenchmark [-s 1M,16M,128M] [-d uniform,sorted,reverse,few,zipf,nearly]
+//                   [-m 1M,16M,256M] [-t threads] [-k fan-in] [--method replace|block]
+//                   [--tapes N] [--delta] [-T dir] [--keep] [--json]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include "extSort.h"
+#ifndef _WIN32
+#include <unistd.h>       // fork, pipe, read, write
+#include <sys/wait.h>     // wait4
+#include <sys/resource.h> // rusage
+#endif
+
+using namespace std;
+
+const size_t FEW_UNIQUE_VALUES = 100;        // # of distinct values of the few-unique distribution
+const size_t ZIPF_VALUES = 1 << 20;          // # of distinct values of the Zipf distribution
+const double ZIPF_EXPONENT = 1.0;            // exponent of the Zipf distribution
+const double NEARLY_SORTED_NOISE = 0.01;     // share of records out of place in the nearly-sorted distribution
+
+/*
+ * Type: BenchResult
+ * -----------------
+ * What one sort of the benchmark did.
+ */
+struct BenchResult
+{
+    double seconds;          // wall-clock time of the sort
+    uint64_t recordNum;      // # of records sorted
+    uint64_t runNum;         // # of runs made by run generation
+    int passNum;             // # of merge passes, or polyphase merge phases
+    uint64_t fanIn;          // max # of runs merged at once
+    bool inMemory;           // whether the input was sorted in memory
+    bool failed;             // whether the sort threw
+    uint64_t peakBytes;      // peak resident memory, 0 if unknown
+};
+
+// Function Prototypes:
+bool parseList(const string& text, vector<string>& items);
+uint64_t generateInput(const string& fileName, const string& dist, uint64_t targetBytes);
+BenchResult timeSort(const string& inName, const string& outName, const SortOptions& options);
+BenchResult runSort(const string& inName, const string& outName, const SortOptions& options);
+string sizeName(uint64_t bytes);
+
+// Main Function:
+int main(int argc, char* argv[]) {
+    vector<string> sizes = { "1M", "16M", "128M" };
+    vector<string> dists = { "uniform", "sorted", "reverse", "few", "zipf", "nearly" };
+    vector<string> budgets = { "1M", "16M", "256M" };
+    SortOptions options = { 0, REPLACEMENT_SELECTION, thread::hardware_concurrency(), 0, false, true, "", false, 0 };
+    bool keep = false, json = false, badArgs = false;
+
+    for (int i = 1; i < argc && !badArgs; i++)
+    {
+        string flag = argv[i];
+        if (flag == "--keep")
+            keep = true;
+        else if (flag == "--json")
+            json = true;
+        else if (flag == "--delta")
+            options.deltaRuns = true;
+        else if (i + 1 == argc)
+            badArgs = true;
+        else
+        {
+            string value = argv[++i];
+            if (flag == "-s" || flag == "--sizes")
+                badArgs = !parseList(value, sizes);
+            else if (flag == "-d" || flag == "--dists")
+                badArgs = !parseList(value, dists);
+            else if (flag == "-m" || flag == "--memory")
+                badArgs = !parseList(value, budgets);
+            else if (flag == "-t" || flag == "--threads")
+                badArgs = (options.threadNum = strtoul(value.c_str(), nullptr, 10)) == 0;
+            else if (flag == "-k" || flag == "--fan-in")
+                badArgs = (options.fanIn = strtoul(value.c_str(), nullptr, 10)) < 2;
+            else if (flag == "--tapes")
+                badArgs = (options.tapeNum = strtoul(value.c_str(), nullptr, 10)) < 3;
+            else if (flag == "--method")
+            {
+                options.runMethod = (value == "block") ? BLOCK_SORT : REPLACEMENT_SELECTION;
+                badArgs = value != "block" && value != "replace";
+            }
+            else if (flag == "-T" || flag == "--temp-dir")
+                options.tempDir = value;
+            else
+                badArgs = true;
+        }
+    }
+    for (size_t i = 0; i < sizes.size(); i++)
+        badArgs = badArgs || parseByteSize(sizes[i]) == 0;
+    for (size_t i = 0; i < budgets.size(); i++)
+        badArgs = badArgs || parseByteSize(budgets[i]) == 0;
+    for (size_t i = 0; i < dists.size(); i++)
+        badArgs = badArgs || (dists[i] != "uniform" && dists[i] != "sorted" && dists[i] != "reverse"
+                              && dists[i] != "few" && dists[i] != "zipf" && dists[i] != "nearly");
+    if (badArgs) {
+        cerr << "Usage: " << argv[0] << " [-s sizes, e.g. 1M,16M,10G] [-d uniform,sorted,reverse,few,zipf,nearly]"
+             << " [-m memory budgets, e.g. 1M,64M] [-t threads] [-k fan-in] [--method replace|block] [--tapes N]"
+             << " [--delta] [-T temp dir] [--keep] [--json]" << endl;
+        return 1;
+    }
+    if (options.threadNum == 0)
+        options.threadNum = 1;
+
+    string dir = options.tempDir.empty() ? "" : options.tempDir + "/";
+    if (!json)
+        cout << left << setw(9) << "dist" << right << setw(8) << "size" << setw(8) << "memory" << setw(10) << "seconds"
+             << setw(9) << "MB/s" << setw(8) << "runs" << setw(8) << "passes" << setw(8) << "fan-in"
+             << setw(10) << "peak MB" << endl;
+    bool firstRow = true;
+    if (json)
+        cout << "[";
+    for (size_t d = 0; d < dists.size(); d++)
+        for (size_t s = 0; s < sizes.size(); s++)
+        {
+            uint64_t targetBytes = parseByteSize(sizes[s]);
+            string inName = dir + "bench_" + dists[d] + "_" + sizes[s] + ".txt";
+            string outName = dir + "bench_" + dists[d] + "_" + sizes[s] + ".sorted.txt";
+            uint64_t bytes;
+            try {
+                bytes = generateInput(inName, dists[d], targetBytes);
+            }
+            catch (const runtime_error& error) {
+                cerr << error.what() << endl;
+                return 1;
+            }
+
+            for (size_t m = 0; m < budgets.size(); m++)
+            {
+                options.memBudget = parseByteSize(budgets[m]);
+                BenchResult result = runSort(inName, outName, options);
+                remove(outName.c_str());
+                double mbPerSecond = (result.seconds > 0) ? bytes / 1048576.0 / result.seconds : 0;
+
+                if (json)
+                {
+                    cout << (firstRow ? "" : ",") << "\n  {\"dist\": \"" << dists[d] << "\", \"bytes\": " << bytes
+                         << ", \"memory_budget\": " << options.memBudget << ", \"threads\": " << options.threadNum
+                         << ", \"failed\": " << (result.failed ? "true" : "false")
+                         << ", \"seconds\": " << result.seconds << ", \"mb_per_second\": " << mbPerSecond
+                         << ", \"records\": " << result.recordNum << ", \"runs\": " << result.runNum
+                         << ", \"passes\": " << result.passNum << ", \"fan_in\": " << result.fanIn
+                         << ", \"in_memory\": " << (result.inMemory ? "true" : "false")
+                         << ", \"peak_bytes\": " << result.peakBytes << "}";
+                    firstRow = false;
+                }
+                else if (result.failed)
+                    cout << left << setw(9) << dists[d] << right << setw(8) << sizeName(bytes)
+                         << setw(8) << budgets[m] << "    sort failed" << endl;
+                else
+                    cout << left << setw(9) << dists[d] << right << setw(8) << sizeName(bytes)
+                         << setw(8) << budgets[m] << fixed << setprecision(3) << setw(10) << result.seconds
+                         << setprecision(1) << setw(9) << mbPerSecond << setw(8) << result.runNum
+                         << setw(8) << (result.inMemory ? string("mem") : to_string(result.passNum))
+                         << setw(8) << result.fanIn << setw(10) << result.peakBytes / 1048576.0 << endl;
+            }
+            if (!keep)
+                remove(inName.c_str());
+        }
+    if (json)
+        cout << "\n]" << endl;
+    return 0;
+}  /* end of main */
+
+
+/// Write a file of integers with a given distribution, as text the sorter reads.
+/// @param fileName name of the file
+/// @param dist "uniform", "sorted", "reverse", "few" (few unique values), "zipf", or
+///             "nearly" (sorted, with a few records anywhere)
+/// @param targetBytes # of bytes of text to write, at least
+/// @return the # of bytes written
+/// @throw runtime_error if the file cannot be written
+uint64_t generateInput(const string& fileName, const string& dist, uint64_t targetBytes)
+{
+    mt19937_64 random(20201017);
+    uniform_int_distribution<int> anyInt(numeric_limits<int>::min(), numeric_limits<int>::max());
+    uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Values of the few-unique and Zipf distributions, and the cumulative Zipf weights:
+    vector<int> values;
+    vector<double> weights;
+    if (dist == "few" || dist == "zipf")
+    {
+        size_t valueNum = (dist == "few") ? FEW_UNIQUE_VALUES : ZIPF_VALUES;
+        for (size_t i = 0; i < valueNum; i++)
+            values.push_back(anyInt(random));
+        double sum = 0;
+        for (size_t i = 0; dist == "zipf" && i < valueNum; i++)
+            weights.push_back(sum += 1.0 / pow(static_cast<double>(i + 1), ZIPF_EXPONENT));
+    }
+
+    // Sorted and reverse values step through the int range, at about 12 bytes of text each:
+    double step = 4294967295.0 / static_cast<double>(targetBytes / 12 + 1);
+
+    ofstream outFile(fileName, ios::binary);
+    if (!outFile)
+        throw runtime_error("Unable to create input file \"" + fileName + "\"");
+    uint64_t bytes = 0;
+    string text;
+    for (uint64_t i = 0; bytes + text.size() < targetBytes; i++)
+    {
+        double position = min(static_cast<double>(i) * step, 4294967295.0);
+        int value;
+        if (dist == "sorted" || (dist == "nearly" && unit(random) >= NEARLY_SORTED_NOISE))
+            value = static_cast<int>(static_cast<int64_t>(position) + numeric_limits<int>::min());
+        else if (dist == "reverse")
+            value = static_cast<int>(numeric_limits<int>::max() - static_cast<int64_t>(position));
+        else if (dist == "few")
+            value = values[random() % values.size()];
+        else if (dist == "zipf")
+            value = values[upper_bound(weights.begin(), weights.end(), unit(random) * weights.back())
+                           - weights.begin()];
+        else
+            value = anyInt(random);
+        RecordText<int>::format(value, text);
+        if (text.size() >= TEXT_BUFFER_BYTES)
+        {
+            outFile.write(text.data(), text.size());
+            bytes += text.size();
+            text.clear();
+        }
+    }
+    outFile.write(text.data(), text.size());
+    bytes += text.size();
+    outFile.close();
+    if (!outFile)
+        throw runtime_error("Unable to write input file \"" + fileName + "\"");
+    return bytes;
+}
+
+/// Sort a file and time it.
+/// @param inName name of the input file
+/// @param outName name of the output file
+/// @param options memory budget and the other settings of the sort
+/// @return what the sort did, without its peak memory
+BenchResult timeSort(const string& inName, const string& outName, const SortOptions& options)
+{
+    BenchResult bench = BenchResult();
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    try {
+        SortResult result = sortFile<int, SortOrder<int> >(inName, outName, options);
+        bench.recordNum = result.recordNum;
+        bench.runNum = result.runNum;
+        bench.passNum = result.passNum;
+        bench.fanIn = result.fanIn;
+        bench.inMemory = result.inMemory;
+    }
+    catch (const runtime_error& error) {
+        cerr << "Unable to sort \"" << inName << "\": " << error.what() << endl;
+        bench.failed = true;
+    }
+    bench.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return bench;
+}
+
+/// Sort a file in a process of its own, so the peak memory of the process is that of the sort.
+/// Where there are no processes to fork, the sort runs in this process and its peak memory is
+/// not known.
+/// @param inName name of the input file
+/// @param outName name of the output file
+/// @param options memory budget and the other settings of the sort
+/// @return what the sort did
+BenchResult runSort(const string& inName, const string& outName, const SortOptions& options)
+{
+#ifndef _WIN32
+    int channel[2];
+    if (pipe(channel) == 0)
+    {
+        cout.flush();
+        pid_t child = fork();
+        if (child == 0)                  // the child sorts and sends back what it did
+        {
+            close(channel[0]);
+            BenchResult bench = timeSort(inName, outName, options);
+            ssize_t sent = write(channel[1], &bench, sizeof(bench));
+            _exit(sent == static_cast<ssize_t>(sizeof(bench)) ? 0 : 1);
+        }
+        close(channel[1]);
+        BenchResult bench = BenchResult();
+        bench.failed = true;
+        if (child > 0)
+        {
+            ssize_t got = read(channel[0], &bench, sizeof(bench));
+            int status;
+            struct rusage usage;
+            if (wait4(child, &status, 0, &usage) == child && got == static_cast<ssize_t>(sizeof(bench)))
+                bench.peakBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // ru_maxrss is in KB
+            else
+                bench.failed = true;
+        }
+        close(channel[0]);
+        return bench;
+    }
+#endif
+    return timeSort(inName, outName, options);
+}
+
+/// Parse a comma-separated list.
+/// @param text the list, e.g. "1M,16M"
+/// @param items set to the items of the list
+/// @return false if the list has an empty item
+bool parseList(const string& text, vector<string>& items)
+{
+    items.clear();
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ','))
+    {
+        if (item.empty())
+            return false;
+        items.push_back(item);
+    }
+    return !items.empty();
+}
+
+/// Write a byte count the short way, e.g. "16M".
+/// @param bytes the byte count
+/// @return the byte count in G, M, K or bytes, rounded
+string sizeName(uint64_t bytes)
+{
+    const char* units[] = { "", "K", "M", "G", "T" };
+    int unit = 0;
+    double size = static_cast<double>(bytes);
+    while (size >= 1024 && unit < 4)
+    {
+        size /= 1024;
+        unit++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(size < 10 && unit > 0 ? 1 : 0) << size << units[unit];
+    return out.str();
+}
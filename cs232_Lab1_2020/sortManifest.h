@@ -0,0 +1,532 @@
+/**********************************************************************
+ * File name: sortManifest.h
+ * -----------------------
+ * This file defines the SortManifest class, which names the temporary
+ * files of an external sort and records its progress, so that a sort
+ * that was interrupted can resume instead of starting over.
+ *
+ * Every temporary file of a sort gets a name that starts with a prefix
+ * unique to that sort, in a scratch directory of the user's choice.
+ *
+ * The manifest is a text file in the scratch directory named with that
+ * prefix too, so sorts that share the directory, even sorts into the
+ * same output, never touch each other's files. It is started with the
+ * sort and names its output file, and when run generation is
+ * complete it lists every run file and its size. Every merge of a group of runs adds
+ * a line with the merged run and its size before the merged runs are
+ * deleted. Only a sort asked to resume looks for the manifest of
+ * another sort: one into the same output whose process has ended. It
+ * rebuilds the merge from these lines and goes on with the first group
+ * not merged. The manifest is deleted with the last run files once the
+ * output is complete, and with every other file of the sort when the
+ * sort fails, so only a sort that was killed leaves files behind.
+ *
+ *      manifest 1
+ *      prefix <prefix of every temporary file>
+ *      output <absolute path of the output file, or - for standard output>
+ *      fanin <fan-in> <run header flags>
+ *      run <bytes> <run file>             one line per run
+ *      runs <# of runs> <# of records>    run generation is complete
+ *      merged <pass> <group> <bytes> <run file>
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef SORTMANIFEST_H
+#define SORTMANIFEST_H
+
+#include <string>      // file names
+#include <vector>      // vector<string> runNames
+#include <map>         // map<string, int64_t> file sizes
+#include <utility>     // pair<int, size_t>
+#include <fstream>     // ifstream, ofstream
+#include <sstream>     // istringstream
+#include <cstdio>      // remove
+#include <cstdlib>     // atol
+#include <cstdint>     // uint32_t, uint64_t
+#include <atomic>      // atomic<unsigned> sort counter
+#include <chrono>      // steady_clock
+#include <stdexcept>   // runtime_error
+#include <filesystem>  // directory_iterator, absolute
+#include <cerrno>      // EPERM
+#ifndef _WIN32
+#include <unistd.h>    // getpid
+#include <signal.h>    // kill
+#else
+#include <process.h>   // _getpid
+#endif
+#include "recordText.h"
+using namespace std;
+
+
+const char* const MANIFEST_SUFFIX = "manifest";     // ends the name of a manifest, after the prefix
+
+
+/*
+ * Type: SortManifest
+ * ------------------
+ * Names the temporary files of one sort and, when checkpointing,
+ * records the runs and merges of the sort in its manifest file.
+ */
+class SortManifest
+{
+private:
+    string tempDir;          // the scratch directory, with a trailing separator, or ""
+    string prefix;           // the start of every temporary file name
+    string fileName;         // the manifest file
+    string output;           // the output file, as recorded in the manifest
+    bool checkpoint;         // whether progress is recorded
+    ofstream out;            // the manifest, while it is being written
+
+    // Where a loaded manifest says the merge stopped:
+    vector<string> passRuns;     // the runs of the pass being merged
+    vector<string> passMerged;   // the groups of that pass merged so far
+    int passDone;                // # of passes complete
+
+    /* Write a line to the manifest and push it to the file system */
+    void record(const string& line);
+
+public:
+    /* Constructor */
+    SortManifest(const string& tempDir, const string& outName, bool checkpoint);
+
+    /* Return the name of run runIndex of merge pass passNum (0 for run generation) */
+    string runName(int passNum, size_t runIndex) const
+    {
+        return prefix + "run" + to_string(passNum) + "_" + to_string(runIndex) + ".run";
+    }
+
+    /* Return the name of tape tapeIndex of a polyphase merge */
+    string tapeName(size_t tapeIndex) const { return prefix + "tape" + to_string(tapeIndex) + ".run"; }
+
+    /* Start the manifest of a new sort */
+    void start();
+
+    /* Take over the manifest of the last interrupted sort into the same output, return false if there is none */
+    bool find();
+
+    /* Record that run generation is complete */
+    void runsDone(const vector<string>& runNames, uint64_t recordNum, size_t fanIn, uint32_t runFlags);
+
+    /* Record that group groupIndex of pass passNum has been merged into mergedName */
+    void groupMerged(int passNum, size_t groupIndex, const string& mergedName);
+
+    /* Delete the manifest once the output is complete */
+    void finish();
+
+    /* Load the manifest found, return false if it has nothing to resume */
+    bool load(uint64_t& recordNum, size_t& runNum, size_t& fanIn, uint32_t& runFlags);
+
+    /* Move a merge to where a loaded sort stopped */
+    void resumePoint(vector<string>& runNames, int& passNum, vector<string>& mergedNames) const;
+
+    /* Delete the manifest and every temporary file of the sort, or of the sort found */
+    void discard();
+
+}; /* end of SortManifest class */
+
+
+/*******************************************************************************************
+ * Function Name: fileBytes
+ * ------------------
+ * Purpose: To find the size of a file.
+ *
+ * Input Parameters:
+ *          name: name of the file.
+ * Output parameters: none.
+ * Return Value:
+ *          int64_t: the # of bytes in the file, or -1 if it cannot be opened.
+ *******************************************************************************************/
+inline int64_t fileBytes(const string& name)
+{
+    ifstream file(name, ios::binary | ios::ate);
+    return file ? static_cast<int64_t>(file.tellg()) : -1;
+}
+
+
+/*******************************************************************************************
+ * Function Name: removeTempFiles
+ * ------------------
+ * Purpose: To delete every file of a scratch directory whose name starts with the prefix
+ *          of a sort: its manifest, runs, merged runs and tapes.
+ *
+ * Input Parameters:
+ *          tempDir: the scratch directory, with a trailing separator, or "".
+ *          prefix: the prefix of the sort, which starts with tempDir.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void removeTempFiles(const string& tempDir, const string& prefix)
+{
+    string start = prefix.substr(tempDir.size());
+    vector<string> names;
+    error_code error;
+    for (filesystem::directory_iterator entry(tempDir.empty() ? "." : tempDir, error), end;
+         !error && entry != end; entry.increment(error))
+    {
+        string name = entry->path().filename().string();
+        if (name.compare(0, start.size(), start) == 0)
+            names.push_back(tempDir + name);
+    }
+    for (size_t i = 0; i < names.size(); i++)
+        remove(names[i].c_str());
+}
+
+
+/*******************************************************************************************
+ * Constructor: SortManifest
+ * ------------------
+ * Purpose: To choose the names of the temporary files and of the manifest. The prefix
+ *          holds the process id, the time and a count of the sorts of this process.
+ *
+ * Input Parameters:
+ *          tempDir: the scratch directory, or "" for the current directory.
+ *          outName: name of the output file, recorded in the manifest.
+ *          checkpoint: whether to record progress in the manifest.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline SortManifest::SortManifest(const string& tempDir, const string& outName, bool checkpoint)
+    : tempDir(tempDir), checkpoint(checkpoint), passDone(0)
+{
+    static atomic<unsigned> sortCount(0);
+
+    if (!this->tempDir.empty() && this->tempDir.back() != '/' && this->tempDir.back() != '\\')
+        this->tempDir += '/';
+#ifndef _WIN32
+    long pid = static_cast<long>(getpid());
+#else
+    long pid = static_cast<long>(_getpid());
+#endif
+    unsigned long long now = static_cast<unsigned long long>(chrono::steady_clock::now().time_since_epoch().count());
+    prefix = this->tempDir + "sort" + to_string(pid) + "_" + to_string(now % 1000000007ULL) + "_"
+           + to_string(sortCount++) + "_";
+
+    fileName = prefix + MANIFEST_SUFFIX;
+    output = (outName == STANDARD_STREAM) ? outName : filesystem::absolute(outName).lexically_normal().string();
+}
+
+
+/*******************************************************************************************
+ * Function Name: record
+ * ------------------
+ * Purpose: To append a line to the manifest and flush it, so it survives the process.
+ *
+ * Input Parameters:
+ *          line: the line, without its newline.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::record(const string& line)
+{
+    out << line << '\n';
+    out.flush();
+    if (!out)
+        throw runtime_error("Unable to write manifest \"" + fileName + "\"");
+}
+
+
+/*******************************************************************************************
+ * Function Name: start
+ * ------------------
+ * Purpose: To start the manifest of a new sort with the prefix of its files and its output.
+ *          The manifests of other sorts, interrupted or not, are left alone.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::start()
+{
+    if (!checkpoint)
+        return;
+    out.open(fileName, ios::trunc);
+    if (!out)
+        throw runtime_error("Unable to create manifest \"" + fileName + "\"");
+    record("manifest 1");
+    record("prefix " + prefix);
+    record("output " + output);
+}
+
+
+/*******************************************************************************************
+ * Function Name: find
+ * ------------------
+ * Purpose: To find the manifest of an interrupted sort into the same output among the
+ *          manifests of the scratch directory, and to take over its name and prefix. The
+ *          manifest of a sort whose process is still running is not taken, nor is one of
+ *          a sort into another output. Of several interrupted sorts into the output, the
+ *          one written last is taken and the files of the others are deleted.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: false if there is no such manifest.
+ *******************************************************************************************/
+inline bool SortManifest::find()
+{
+    vector<pair<string, string> > found;         // manifest file and prefix
+    size_t last = 0;                             // the one written last
+    filesystem::file_time_type lastTime = filesystem::file_time_type::min();
+    error_code error;
+    string suffix = MANIFEST_SUFFIX;
+    for (filesystem::directory_iterator entry(tempDir.empty() ? "." : tempDir, error), end;
+         !error && entry != end; entry.increment(error))
+    {
+        string name = entry->path().filename().string();
+        if (name.compare(0, 4, "sort") != 0 || name.size() <= suffix.size()
+            || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+
+        ifstream in(tempDir + name);
+        string line, oldPrefix, oldOutput;
+        while (getline(in, line) && (oldPrefix.empty() || oldOutput.empty()))
+        {
+            if (line.compare(0, 7, "prefix ") == 0)
+                oldPrefix = line.substr(7);
+            else if (line.compare(0, 7, "output ") == 0)
+                oldOutput = line.substr(7);
+        }
+        if (oldOutput != output || oldPrefix != tempDir + name.substr(0, name.size() - suffix.size()))
+            continue;
+#ifndef _WIN32
+        long pid = atol(name.c_str() + 4);       // the prefix starts with "sort<pid>_"
+        if (pid > 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM))
+            continue;                            // that sort is still running
+#endif
+        filesystem::file_time_type time = entry->last_write_time(error);
+        if (found.empty() || (!error && time > lastTime))
+        {
+            last = found.size();
+            lastTime = time;
+        }
+        error.clear();
+        found.push_back(make_pair(tempDir + name, oldPrefix));
+    }
+    if (found.empty())
+        return false;
+    for (size_t i = 0; i < found.size(); i++)
+        if (i != last)
+            removeTempFiles(tempDir, found[i].second);
+    fileName = found[last].first;
+    prefix = found[last].second;
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: runsDone
+ * ------------------
+ * Purpose: To record the runs once run generation is complete.
+ *
+ * Input Parameters:
+ *          runNames: names of the run files.
+ *          recordNum: # of records read.
+ *          fanIn: max # of runs merged at once, which a resumed sort must keep.
+ *          runFlags: header flags of the runs.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::runsDone(const vector<string>& runNames, uint64_t recordNum, size_t fanIn,
+                                   uint32_t runFlags)
+{
+    if (!checkpoint || !out.is_open())
+        return;
+    record("fanin " + to_string(fanIn) + " " + to_string(runFlags));
+    for (size_t i = 0; i < runNames.size(); i++)
+        record("run " + to_string(fileBytes(runNames[i])) + " " + runNames[i]);
+    record("runs " + to_string(runNames.size()) + " " + to_string(recordNum));
+}
+
+
+/*******************************************************************************************
+ * Function Name: groupMerged
+ * ------------------
+ * Purpose: To record a merged group of runs, before the runs of the group are deleted.
+ *
+ * Input Parameters:
+ *          passNum: the merge pass, from 1.
+ *          groupIndex: the group within the pass, from 0.
+ *          mergedName: name of the merged run.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::groupMerged(int passNum, size_t groupIndex, const string& mergedName)
+{
+    if (checkpoint && out.is_open())
+        record("merged " + to_string(passNum) + " " + to_string(groupIndex) + " "
+               + to_string(fileBytes(mergedName)) + " " + mergedName);
+}
+
+
+/*******************************************************************************************
+ * Function Name: finish
+ * ------------------
+ * Purpose: To delete the manifest once the output file is complete.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::finish()
+{
+    if (out.is_open())
+        out.close();
+    if (checkpoint)
+        remove(fileName.c_str());
+}
+
+
+/*******************************************************************************************
+ * Function Name: load
+ * ------------------
+ * Purpose: To load the manifest found by find. The run files are replayed through
+ *          the recorded merges, pass by pass with the recorded fan-in, which leaves the runs
+ *          of the pass that was going on and the groups of it already merged. Every file
+ *          still needed must have its recorded size; runs of merged groups that were not
+ *          deleted yet are deleted now. Later lines of the manifest are appended to it.
+ *
+ * Input Parameters: none.
+ * Output parameters:
+ *          recordNum: the # of records of the interrupted sort.
+ *          runNum: the # of runs made by its run generation.
+ *          fanIn: its fan-in.
+ *          runFlags: the header flags of its runs.
+ * Return Value:
+ *          bool: false if there is no manifest, or run generation had not completed.
+ *******************************************************************************************/
+inline bool SortManifest::load(uint64_t& recordNum, size_t& runNum, size_t& fanIn, uint32_t& runFlags)
+{
+    ifstream in(fileName);
+    if (!in)
+        return false;
+
+    map<string, int64_t> sizes;
+    vector<string> runs;
+    vector<string> merged;                       // the merged runs, in the order merged
+    vector<pair<int, size_t> > mergedAt;         // the pass and group of every merged run
+    bool complete = false;
+    string line;
+    fanIn = 0;
+    while (getline(in, line) && !in.eof())   // a last line without its newline was cut off
+    {
+        istringstream fields(line);
+        string tag;
+        fields >> tag;
+        if (tag == "prefix")
+        {
+            fields.get();                        // the space before the prefix
+            getline(fields, prefix);
+        }
+        else if (tag == "fanin")
+            fields >> fanIn >> runFlags;
+        else if (tag == "run" || tag == "merged")
+        {
+            int passNum = 0;
+            size_t groupIndex = 0;
+            int64_t bytes;
+            string name;
+            if (tag == "merged")
+                fields >> passNum >> groupIndex;
+            fields >> bytes;
+            fields.get();                        // the space before the name
+            getline(fields, name);
+            sizes[name] = bytes;
+            if (tag == "run")
+                runs.push_back(name);
+            else
+            {
+                merged.push_back(name);
+                mergedAt.push_back(make_pair(passNum, groupIndex));
+            }
+        }
+        else if (tag == "runs")
+            complete = static_cast<bool>(fields >> runNum >> recordNum);
+    }
+    in.close();
+    if (!complete || fanIn < 2)
+        return false;
+
+    // Replay the merges pass by pass:
+    passRuns = runs;
+    passMerged.clear();
+    passDone = 0;
+    vector<string> consumed;                     // runs of merged groups
+    for (size_t m = 0; m < merged.size(); m++)
+    {
+        size_t groupNum = (passRuns.size() + fanIn - 1) / fanIn;
+        if (passRuns.size() <= fanIn || mergedAt[m].first != passDone + 1 || mergedAt[m].second != passMerged.size())
+            throw runtime_error("Unable to resume: manifest \"" + fileName + "\" is out of order");
+        size_t first = mergedAt[m].second * fanIn;
+        for (size_t i = first; i < first + fanIn && i < passRuns.size(); i++)
+            consumed.push_back(passRuns[i]);
+        passMerged.push_back(merged[m]);
+        if (passMerged.size() == groupNum)       // the pass is complete
+        {
+            passRuns.swap(passMerged);
+            passMerged.clear();
+            passDone++;
+        }
+    }
+
+    // Every file still needed must be whole:
+    vector<string> needed(passMerged);
+    for (size_t i = passMerged.size() * fanIn; i < passRuns.size(); i++)
+        needed.push_back(passRuns[i]);
+    for (size_t i = 0; i < needed.size(); i++)
+        if (fileBytes(needed[i]) != sizes[needed[i]])
+            throw runtime_error("Unable to resume: run file \"" + needed[i] + "\" is missing or damaged");
+    for (size_t i = 0; i < consumed.size(); i++)
+        remove(consumed[i].c_str());
+
+    out.open(fileName, ios::app);
+    if (!out)
+        throw runtime_error("Unable to write manifest \"" + fileName + "\"");
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: resumePoint
+ * ------------------
+ * Purpose: To move a merge to where a loaded sort stopped. A sort that was not loaded
+ *          leaves the merge as it is.
+ *
+ * Input Parameters: none.
+ * Output parameters:
+ *          runNames: the runs of the pass that was going on.
+ *          passNum: the # of passes complete.
+ *          mergedNames: the merged runs of the groups of that pass already merged.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::resumePoint(vector<string>& runNames, int& passNum, vector<string>& mergedNames) const
+{
+    if (passRuns.empty())
+        return;
+    runNames = passRuns;
+    passNum = passDone;
+    mergedNames = passMerged;
+}
+
+
+/*******************************************************************************************
+ * Function Name: discard
+ * ------------------
+ * Purpose: To delete the manifest and every temporary file named by the prefix: those of
+ *          this sort when it fails, or those of the sort found by find when it cannot be
+ *          resumed, because its run generation did not complete or its files are damaged.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortManifest::discard()
+{
+    if (out.is_open())
+        out.close();
+    removeTempFiles(tempDir, prefix);
+}
+
+#endif //SORTMANIFEST_H
@@ -0,0 +1,366 @@
+/**********************************************************************
+ * File name: sortStats.h
+ * -----------------------
+ * This file defines the statistics of the external sort: counters and
+ * timers for every phase of a sort, so the memory budget and fan-in
+ * can be tuned from what a sort actually did.
+ *
+ * A phase is run generation, one merge pass, or the final merge. The
+ * readers and writers of text and run files count the bytes and the
+ * records they move, a buffer at a time, and time every wait for a
+ * read or a write; the phases count the runs they create. Reads and
+ * writes done in the background are counted, but only the time the
+ * sort is blocked on them is I/O time. Comparisons are counted by
+ * sorting with a CountingOrder, which costs a little speed, so the
+ * sort only does that when asked to.
+ *
+ * The counters are shared by the whole process, so two sorts at once
+ * would mix theirs.
+ *
+ * This file defines the
+ *      PhaseStats type:     what one phase of a sort did.
+ *      SortStats class:     the counters and the phases of the process.
+ *      IoTimer class:       times one wait for a read or a write.
+ *      CountingOrder type:  an order that counts its comparisons.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef SORTSTATS_H
+#define SORTSTATS_H
+
+#include <iostream>    // ostream
+#include <string>      // phase names
+#include <vector>      // vector<PhaseStats> phases
+#include <cstdint>     // uint64_t
+#include <ctime>       // clock
+#include <chrono>      // steady_clock
+#include <atomic>      // atomic<uint64_t> counters
+#include <mutex>       // mutex, lock_guard
+using namespace std;
+
+
+/*
+ * Type: PhaseStats
+ * ----------------
+ * What one phase of a sort did. Times are in seconds; cpuSeconds and
+ * ioSeconds are summed over all threads, so either may exceed seconds.
+ */
+struct PhaseStats
+{
+    string name;             // "run generation", "merge pass 1", ..., "final merge"
+    double seconds;          // wall-clock time
+    double cpuSeconds;       // CPU time of the process
+    double ioSeconds;        // time blocked on reads and writes
+    uint64_t bytesRead;      // bytes of text and run files read
+    uint64_t bytesWritten;   // bytes of text and run files written
+    uint64_t recordsRead;    // records read from text and run files
+    uint64_t recordsWritten; // records written to text and run files
+    uint64_t comparisons;    // comparisons of records or keys, if counted
+    uint64_t runs;           // runs created
+    size_t fanIn;            // max # of runs merged at once, 0 for run generation
+};
+
+
+/*
+ * Type: SortStats
+ * ---------------
+ * The counters of the phase going on, and the phases done so far.
+ */
+class SortStats
+{
+private:
+    atomic<uint64_t> bytesRead, bytesWritten, recordsRead, recordsWritten, comparisons, runs, ioNanos;
+    mutex lock;                              // guards the phases
+    vector<PhaseStats> phases;               // the phases done
+    PhaseStats current;                      // the phase going on
+    chrono::steady_clock::time_point start;  // when it began
+    clock_t cpuStart;                        // the CPU time of the process when it began
+
+    /* Take the counters and reset them */
+    static uint64_t take(atomic<uint64_t>& counter) { return counter.exchange(0); }
+
+public:
+    /* Constructor */
+    SortStats() : bytesRead(0), bytesWritten(0), recordsRead(0), recordsWritten(0), comparisons(0), runs(0),
+                  ioNanos(0), cpuStart(0) {}
+
+    /* Count what a reader or writer moved, and what a phase created */
+    void addBytesRead(uint64_t n) { bytesRead.fetch_add(n, memory_order_relaxed); }
+    void addBytesWritten(uint64_t n) { bytesWritten.fetch_add(n, memory_order_relaxed); }
+    void addRecordsRead(uint64_t n) { recordsRead.fetch_add(n, memory_order_relaxed); }
+    void addRecordsWritten(uint64_t n) { recordsWritten.fetch_add(n, memory_order_relaxed); }
+    void addComparisons(uint64_t n) { comparisons.fetch_add(n, memory_order_relaxed); }
+    void addRuns(uint64_t n) { runs.fetch_add(n, memory_order_relaxed); }
+    void addIoTime(uint64_t nanos) { ioNanos.fetch_add(nanos, memory_order_relaxed); }
+
+    /* Begin a phase; what was counted before it is dropped */
+    void beginPhase(const string& name, size_t fanIn = 0);
+
+    /* End the phase going on and keep what it did */
+    void endPhase();
+
+    /* Return the phases done */
+    vector<PhaseStats> phaseList();
+
+    /* Drop the phases done */
+    void clear();
+
+    /* Write the phases done, and their totals, as a JSON object */
+    void writeJson(ostream& out);
+
+}; /* end of SortStats class */
+
+
+/*
+ * Type: IoTimer
+ * -------------
+ * Adds the time from its construction to its destruction to the I/O
+ * time of the phase, around a read or write the sort has to wait for.
+ */
+class IoTimer
+{
+private:
+    chrono::steady_clock::time_point start;  // when the wait began
+
+public:
+    IoTimer() : start(chrono::steady_clock::now()) {}
+    ~IoTimer();
+};
+
+
+/*
+ * Type: ComparisonCount
+ * ---------------------
+ * The comparisons of one thread, counted without sharing a cache line
+ * with the other threads. They are added to the phase when the thread
+ * ends, and those of the thread that ends a phase when it does.
+ */
+struct ComparisonCount
+{
+    uint64_t count;          // comparisons not yet added to the phase
+
+    ~ComparisonCount();
+};
+
+/*
+ * Type: CountingOrder
+ * -------------------
+ * Orders records like Order and counts every comparison, of records
+ * or of keys. It keeps the Key and KeyCompare of Order, so a sort may
+ * still radix sort integer keys, which takes no comparisons at all.
+ */
+template <typename Order>
+struct CountingOrder : Order
+{
+    /* Constructor */
+    explicit CountingOrder(const Order& order = Order()) : Order(order) {}
+
+    /* Test whether key a comes before key b */
+    bool keyLess(const typename Order::Key& a, const typename Order::Key& b) const;
+
+    /* Test whether record a comes before record b */
+    template <typename Record>
+    bool operator()(const Record& a, const Record& b) const;
+};
+
+
+// Function Prototypes:
+SortStats& sortStats();
+ComparisonCount& threadComparisons();
+
+
+/*******************************************************************************************
+ * Function Name: sortStats / threadComparisons
+ * ------------------
+ * Purpose: To find the statistics of the process, and the comparison count of this thread.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          SortStats&: the statistics.
+ *          ComparisonCount&: the comparisons of this thread not yet added to the statistics.
+ *******************************************************************************************/
+inline SortStats& sortStats()
+{
+    static SortStats stats;
+    return stats;
+}
+
+inline ComparisonCount& threadComparisons()
+{
+    thread_local ComparisonCount comparisons = { 0 };
+    return comparisons;
+}
+
+
+/*******************************************************************************************
+ * Destructor: IoTimer / ComparisonCount
+ * ------------------
+ * Purpose: To add the time of a wait, or the comparisons of a thread that ends, to the phase.
+ *******************************************************************************************/
+inline IoTimer::~IoTimer()
+{
+    sortStats().addIoTime(static_cast<uint64_t>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count()));
+}
+
+inline ComparisonCount::~ComparisonCount()
+{
+    sortStats().addComparisons(count);
+}
+
+
+/*******************************************************************************************
+ * Function Name: keyLess / operator()
+ * ------------------
+ * Purpose: To compare two keys, or two records, by Order and count the comparison.
+ *
+ * Input Parameters:
+ *          a, b: the keys or records.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: true if a comes before b.
+ *******************************************************************************************/
+template <typename Order>
+bool CountingOrder<Order>::keyLess(const typename Order::Key& a, const typename Order::Key& b) const
+{
+    threadComparisons().count++;
+    return Order::keyLess(a, b);
+}
+
+template <typename Order>
+template <typename Record>
+bool CountingOrder<Order>::operator()(const Record& a, const Record& b) const
+{
+    threadComparisons().count++;
+    return Order::operator()(a, b);
+}
+
+
+/*******************************************************************************************
+ * Function Name: beginPhase / endPhase
+ * ------------------
+ * Purpose: To reset the counters for a new phase, and to keep what a phase did when it ends.
+ *
+ * Input Parameters:
+ *          name: the name of the phase.
+ *          fanIn: max # of runs the phase merges at once, 0 for run generation.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortStats::beginPhase(const string& name, size_t fanIn)
+{
+    threadComparisons().count = 0;
+    take(bytesRead);
+    take(bytesWritten);
+    take(recordsRead);
+    take(recordsWritten);
+    take(comparisons);
+    take(runs);
+    take(ioNanos);
+
+    lock_guard<mutex> guard(lock);
+    current = PhaseStats();
+    current.name = name;
+    current.fanIn = fanIn;
+    start = chrono::steady_clock::now();
+    cpuStart = clock();
+}
+
+inline void SortStats::endPhase()
+{
+    ComparisonCount& own = threadComparisons();
+    addComparisons(own.count);
+    own.count = 0;
+
+    lock_guard<mutex> guard(lock);
+    current.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    current.cpuSeconds = static_cast<double>(clock() - cpuStart) / CLOCKS_PER_SEC;
+    current.ioSeconds = static_cast<double>(take(ioNanos)) / 1e9;
+    current.bytesRead = take(bytesRead);
+    current.bytesWritten = take(bytesWritten);
+    current.recordsRead = take(recordsRead);
+    current.recordsWritten = take(recordsWritten);
+    current.comparisons = take(comparisons);
+    current.runs = take(runs);
+    phases.push_back(current);
+}
+
+
+/*******************************************************************************************
+ * Function Name: phaseList / clear
+ * ------------------
+ * Purpose: To return the phases done, and to drop them.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          vector<PhaseStats>: the phases done, in order.
+ *******************************************************************************************/
+inline vector<PhaseStats> SortStats::phaseList()
+{
+    lock_guard<mutex> guard(lock);
+    return phases;
+}
+
+inline void SortStats::clear()
+{
+    lock_guard<mutex> guard(lock);
+    phases.clear();
+}
+
+
+/*******************************************************************************************
+ * Function Name: writeJson
+ * ------------------
+ * Purpose: To write the phases done and their totals as a JSON object:
+ *          { "phases": [ { "name": ..., "seconds": ..., ... }, ... ], "total": { ... } }
+ *
+ * Input Parameters:
+ *          out: the stream to write to.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void SortStats::writeJson(ostream& out)
+{
+    vector<PhaseStats> list = phaseList();
+    PhaseStats total = PhaseStats();
+    total.name = "total";
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        total.seconds += list[i].seconds;
+        total.cpuSeconds += list[i].cpuSeconds;
+        total.ioSeconds += list[i].ioSeconds;
+        total.bytesRead += list[i].bytesRead;
+        total.bytesWritten += list[i].bytesWritten;
+        total.recordsRead += list[i].recordsRead;
+        total.recordsWritten += list[i].recordsWritten;
+        total.comparisons += list[i].comparisons;
+        total.runs += list[i].runs;
+        if (list[i].fanIn > total.fanIn)
+            total.fanIn = list[i].fanIn;
+    }
+    list.push_back(total);
+
+    out << "{\"phases\": [";
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        const PhaseStats& phase = list[i];
+        if (i + 1 == list.size())
+            out << "], \"total\": ";
+        else if (i > 0)
+            out << ", ";
+        out << "{\"name\": \"" << phase.name << "\", \"seconds\": " << phase.seconds
+            << ", \"cpu_seconds\": " << phase.cpuSeconds << ", \"io_seconds\": " << phase.ioSeconds
+            << ", \"bytes_read\": " << phase.bytesRead << ", \"bytes_written\": " << phase.bytesWritten
+            << ", \"records_read\": " << phase.recordsRead << ", \"records_written\": " << phase.recordsWritten
+            << ", \"comparisons\": " << phase.comparisons << ", \"runs\": " << phase.runs
+            << ", \"fan_in\": " << phase.fanIn << "}";
+    }
+    out << "}";
+}
+
+#endif //SORTSTATS_H
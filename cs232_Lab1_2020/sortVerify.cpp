@@ -0,0 +1,112 @@
+// Jian Zhong
+// CS232 Lab1
+// 10/17/2026
+// sortVerify.cpp
+//
+// Verifier of a sorted file: reads the file once, checks that every record is in
+// order, and counts and checksums its records. Given the input of the sort as well,
+// it checks that the sort neither dropped nor duplicated a record, without sorting
+// anything again.
+//
+//     sortVerify [-f int|log] [-u] [-i input file] [sorted file, - for standard input]
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include "extVerify.h"
+#include "logRecord.h"
+
+using namespace std;
+
+// Function Prototypes:
+template <typename Record, typename KeyOf>
+bool verifySorted(const string& inName, const string& sortedName, bool strict);
+void printResult(const string& fileName, const VerifyResult& result, bool ordered);
+
+// Main Function:
+int main(int argc, char* argv[]) {
+    string format = "int";
+    string inName, sortedName = STANDARD_STREAM;
+    bool strict = false, badArgs = false, named = false;
+
+    for (int i = 1; i < argc && !badArgs; i++)
+    {
+        string flag = argv[i];
+        if (flag == "-u" || flag == "--unique")
+            strict = true;
+        else if ((flag == "-f" || flag == "--format") && i + 1 < argc)
+            badArgs = (format = argv[++i]) != "int" && format != "log";
+        else if ((flag == "-i" || flag == "--input") && i + 1 < argc)
+            inName = argv[++i];
+        else if ((flag[0] != '-' || flag == STANDARD_STREAM) && !named)
+        {
+            sortedName = flag;
+            named = true;
+        }
+        else
+            badArgs = true;
+    }
+    if (badArgs || inName == STANDARD_STREAM) {
+        cerr << "Usage: " << argv[0] << " [-f int|log] [-u, if the sort kept one record per key]"
+             << " [-i input file of the sort] [sorted file, - for standard input (default)]" << endl;
+        return 2;
+    }
+
+    try {
+        bool good = (format == "log") ? verifySorted<LogRecord, LogTimestamp>(inName, sortedName, strict)
+                                      : verifySorted<int, IdentityKey>(inName, sortedName, strict);
+        return good ? 0 : 1;
+    }
+    catch (const runtime_error& error) {
+        cerr << error.what() << endl;
+        return 2;
+    }
+}  /* end of main */
+
+
+/// Verify that a file is sorted and, if the input of the sort is given, that it holds the
+/// same records as the input: the same # of records with the same checksum, or no more
+/// records than the input if the sort kept one record per key.
+/// @param inName name of the input file of the sort, "" for none
+/// @param sortedName name of the sorted file, "-" for standard input
+/// @param strict whether records with equal keys are out of order
+/// @return true if the file passed every check
+template <typename Record, typename KeyOf>
+bool verifySorted(const string& inName, const string& sortedName, bool strict)
+{
+    typedef SortOrder<Record, KeyOf> Order;
+
+    VerifyResult sorted = verifyFile<Record, Order>(sortedName, strict);
+    printResult(sortedName, sorted, true);
+    bool good = sorted.sorted;
+    if (inName.empty())
+        return good;
+
+    VerifyResult input = verifyFile<Record, Order>(inName);
+    printResult(inName, input, false);
+    if (strict ? sorted.recordNum > input.recordNum
+               : sorted.recordNum != input.recordNum || sorted.checksum != input.checksum)
+    {
+        cout << "\"" << sortedName << "\" does not hold the records of \"" << inName << "\"" << endl;
+        return false;
+    }
+    if (!strict)
+        cout << "\"" << sortedName << "\" holds the records of \"" << inName << "\"" << endl;
+    return good;
+}
+
+/// Print what the verification of a file found.
+/// @param fileName name of the file
+/// @param result the # of records, their checksum and whether they are in order
+/// @param ordered whether the file should be in order
+void printResult(const string& fileName, const VerifyResult& result, bool ordered)
+{
+    cout << "\"" << fileName << "\": " << result.recordNum << " records, checksum " << hex << setfill('0')
+         << setw(16) << result.checksum << dec << setfill(' ');
+    if (!ordered)
+        cout << endl;
+    else if (result.sorted)
+        cout << ", sorted" << endl;
+    else
+        cout << ", record " << result.firstUnsorted << " out of order" << endl;
+}
@@ -12,6 +12,11 @@
 *   Date Written:		June 2009
 *
 *   Date Last Revised:		March 2010 - added mergesort algorithms
+*				October 2026 - added pdqSort and heapSort, and comparators
+*				of any callable type; mergesorts reuse one scratch array;
+*				parallel mergesort and quicksort; SIMD sorting networks
+*				as the base case for ints and floats; msSort also sorts
+*				the blocks of the external sort
 *
 ******************************************************************************************/
 
@@ -31,6 +36,15 @@ using std::streampos;
 using std::ios;
 using std::endl;
 
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <iterator>
+
+#include "taskPool.h"
+#include "simdSort.h"
+
 
 
 
@@ -54,10 +68,10 @@ using std::endl;
 template <typename T>
 void swap( T &a, T &b )
 {
-  T temp = a;
+  T temp = std::move( a );
 
-  a = b;
-  b = temp;
+  a = std::move( b );
+  b = std::move( temp );
 }
 
 
@@ -77,8 +91,8 @@ void swap( T &a, T &b )
 ******************************************************************************************/
 
 
-template <typename T>
-void selectSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+template <typename T, typename Compare>
+void selectSort( T* arrayptr, int arraySize,  Compare cmp )
 {
   int smallindex; // index of smallest element in the sublist
   int pass, j;
@@ -117,8 +131,8 @@ void selectSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &ba
 ******************************************************************************************/
 
 
-template <typename T>
-void doubleSeletcSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+template <typename T, typename Compare>
+void doubleSeletcSort( T* arrayptr, int arraySize,  Compare cmp )
 {
   // index of smallest and largest elements in a sublist
   int smallIndex, largeIndex;
@@ -186,8 +200,8 @@ void doubleSeletcSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1,
 ******************************************************************************************/
 
 
-template <typename T>
-void insertionSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 )   )
+template <typename T, typename Compare>
+void insertionSort( T* arrayptr, int arraySize,  Compare cmp )
 {
   int i, j;
   T target;
@@ -201,18 +215,18 @@ void insertionSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T
       // correct position to locate target. assigns it to
       // arrayptr[j]
       j = i;
-      target = arrayptr[i];
+      target = std::move( arrayptr[i] );
       // locate insertion point by scanning downward as long
       // as target < arrayptr[j-1] and we have not encountered the
       // beginning of the list
-      while (j > 0 && target < arrayptr[j-1])
+      while (j > 0 && cmp( target, arrayptr[j-1] ))
         {
           // shift elements up list to make room for insertion
-          arrayptr[j] = arrayptr[j-1];
+          arrayptr[j] = std::move( arrayptr[j-1] );
           j--;
         }
       // the location is found; insert target
-      arrayptr[j] = target;
+      arrayptr[j] = std::move( target );
     }
 }
 
@@ -233,10 +247,10 @@ void insertionSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T
 ******************************************************************************************/
 
 
-template <typename T>
-void bubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+template <typename T, typename Compare>
+void bubbleSort( T* arrayptr, int arraySize,  Compare cmp )
 {
-  register int i,j;
+  int i,j;
   // index of last exchange
   bool did_swap = true;
 
@@ -282,10 +296,10 @@ void bubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &ba
 
 
 
-template <typename T>
-void basicBubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+template <typename T, typename Compare>
+void basicBubbleSort( T* arrayptr, int arraySize,  Compare cmp )
 {
-  register int i,j;
+  int i,j;
 
   for ( i = 1; i < arraySize; i++ )
     {
@@ -301,138 +315,223 @@ void basicBubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1,
 
 
 
+const int MERGE_INSERTION_CUTOFF = 16;        // mergesorts insertion sort ranges up to this size
+const int MERGE_BOTTOM_UP_RUN = 32;           // bottomUpMergeSort starts from runs of this size
+
+
+template <typename T, typename Compare>
+void sortmerge1( T* arrayptr, T* temp, int l, int r, Compare cmp );
+template <typename T, typename Compare>
+void mergesort2( T* source, T* dest, int l, int r, Compare cmp );
+template <typename T, typename Compare>
+void mergesort2Within( T* arrayptr, T* scratch, int l, int r, Compare cmp );
+template <typename T, typename Compare>
+void merge2( T* source,  T* arrayptr , int l, int mid,  int r, Compare cmp );
+
+
 /******************************************************************************************
 *
-*   Function Name:
-*
-*   Purpose:
+*   Function Name:		mergesort1
 *
+*   Purpose:			sorts an array by top-down mergesort with one scratch array
+*				of arraySize elements, which the caller may pass in to sort
+*				many arrays without allocating; otherwise it is allocated
+*				once for the sort
 *
-*   Input Parameters:
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				scratch - arraySize elements of scratch space,
+*				cmp - true if the first element comes before the second
+*				(operator< if not given)
 *
-*   Output parameters:
+*   Output parameters:		arrayptr - the sorted array
 *
-*   Return Value:
+*   Return Value:		none
 *
 ******************************************************************************************/
 
 
+template <typename T, typename Compare>
+void mergesort1( T* arrayptr, int arraySize, T* scratch, Compare cmp )
+{
+  if ( arraySize > 1 )
+    sortmerge1( arrayptr, scratch, 0, arraySize - 1, cmp );
+}
+
+
+template <typename T, typename Compare>
+void mergesort1( T* arrayptr, int arraySize, Compare cmp )
+{
+  std::vector<T> scratch( arraySize > 1 ? arraySize : 0 );
+
+  mergesort1( arrayptr, arraySize, scratch.data(), cmp );
+}
+
+
 template <typename T>
-void mergesort1(T* arrayptr, const int& arraySize )
+void mergesort1( T* arrayptr, const int& arraySize )
 {
-  sortmerge1( arrayptr, arraySize, 0, arraySize - 1 );
+  mergesort1( arrayptr, arraySize, std::less<T>() );
 }
 
 
 
 /******************************************************************************************
 *
-*   Function Name:
-*
-*   Purpose:
+*   Function Name:		sortmerge1
 *
+*   Purpose:			sorts arrayptr[l..r]: sorts both halves, moves the left half
+*				into temp in order and the right half in reverse order, and
+*				merges from both ends of temp toward the middle, so neither
+*				end of the merge needs a bounds check. Not stable.
 *
-*   Input Parameters:
+*   Input Parameters:		arrayptr - the array, temp - scratch space for arrayptr[l..r],
+*				l, r - the range to sort,
+*				cmp - true if the first element comes before the second
 *
-*   Output parameters:
+*   Output parameters:		arrayptr - the array with the range sorted
 *
-*   Return Value:
+*   Return Value:		none
 *
 ******************************************************************************************/
 
 
-template <typename T>
-void sortmerge1( T* arrayptr, const int& arraySize, int l, int r )
+template <typename T, typename Compare>
+void sortmerge1( T* arrayptr, T* temp, int l, int r, Compare cmp )
 {
 
   int mid, i, j, k;
 
 
-
-  if ( l < r )
+  if ( r - l < SIMD_SORT_MAX && simdSort( arrayptr + l, r - l + 1, cmp ) )
+    return;
+  if ( r - l < MERGE_INSERTION_CUTOFF )
     {
-      mid = (r + l)/2;
-
-      sortmerge1( arrayptr, arraySize, l, mid );
-      sortmerge1( arrayptr, arraySize, mid + 1, r );
-
-      T* temp = new T[ arraySize ]; 
+      insertionSort( arrayptr + l, r - l + 1, cmp );
+      return;
+    }
 
-      for ( i = mid + 1; i > l; i-- )
-        temp[ i - 1 ]= arrayptr[ i - 1 ];
+  mid = l + (r - l)/2;
 
-      for ( j = mid; j < r; j++ )
-        temp[ r + mid - j ] = arrayptr[ j + 1 ];
+  sortmerge1( arrayptr, temp, l, mid, cmp );
+  sortmerge1( arrayptr, temp, mid + 1, r, cmp );
 
-      for ( k = l; k <= r; k++)
-        arrayptr[k] = ( temp[i] < temp[j] )  ?  temp[i++] : temp[j--];
+  for ( i = mid + 1; i > l; i-- )
+    temp[ i - 1 ] = std::move( arrayptr[ i - 1 ] );
 
-    }
+  for ( j = mid; j < r; j++ )
+    temp[ r + mid - j ] = std::move( arrayptr[ j + 1 ] );
 
+  for ( k = l; k <= r; k++)
+    arrayptr[k] = cmp( temp[j], temp[i] )  ?  std::move( temp[j--] ) : std::move( temp[i++] );
 
-  temp = 0;
-  delete [] temp;
 }
 
 
 
 /******************************************************************************************
 *
-*   Function Name:
-*
-*   Purpose:
+*   Function Name:		msSort
 *
+*   Purpose:			sorts an array by a stable top-down mergesort that merges
+*				back and forth between the array and one scratch array of
+*				arraySize elements, moving every element once per level. The
+*				caller may pass the scratch array in to sort many arrays
+*				without allocating; otherwise it is allocated once for the sort.
 *
-*   Input Parameters:
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				scratch - arraySize elements of scratch space,
+*				cmp - true if the first element comes before the second
+*				(operator< if not given)
 *
-*   Output parameters:
+*   Output parameters:		arrayptr - the sorted array
 *
-*   Return Value:
+*   Return Value:		none
 *
 ******************************************************************************************/
 
 
-template <typename T>
-void msSort( T* arrayptr, const int& arraySize )
+template <typename T, typename Compare>
+void msSort( T* arrayptr, int arraySize, T* scratch, Compare cmp )
 {
+  if ( arraySize > 1 )
+    mergesort2Within( arrayptr, scratch, 0, arraySize - 1, cmp );
+}
 
-  T* copy = new T[ arraySize ];
-  int i;
-  for ( i =  0; i < arraySize; i++ )
-    copy[i] = arrayptr[i];
 
-  mergesort2( copy, arrayptr, 0, arraySize - 1 );
+template <typename T, typename Compare>
+void msSort( T* arrayptr, int arraySize, Compare cmp )
+{
+  std::vector<T> scratch( arraySize > 1 ? arraySize : 0 );
+
+  msSort( arrayptr, arraySize, scratch.data(), cmp );
+}
+
 
+template <typename T>
+void msSort( T* arrayptr, const int& arraySize )
+{
+  msSort( arrayptr, arraySize, std::less<T>() );
 }
 
 
 
 /******************************************************************************************
 *
-*   Function Name:
-*
-*   Purpose:
+*   Function Name:		mergesort2, mergesort2Within
 *
+*   Purpose:			mergesort2 sorts source[l..r] into dest[l..r], using
+*				source[l..r] as scratch space; mergesort2Within sorts
+*				arrayptr[l..r] where it is, using scratch[l..r]. Each sorts
+*				both halves with the other, so the halves end up where the
+*				merge reads them without an extra copy.
 *
-*   Input Parameters:
+*   Input Parameters:		source, arrayptr - the elements to sort, dest, scratch - the
+*				other array, l, r - the range to sort,
+*				cmp - true if the first element comes before the second
 *
-*   Output parameters:
+*   Output parameters:		dest, arrayptr - the sorted range
 *
-*   Return Value:
+*   Return Value:		none
 *
 ******************************************************************************************/
 
 
-template <typename T>
-void mergesort2( T* source, T* dest, int l, int r )
+template <typename T, typename Compare>
+void mergesort2( T* source, T* dest, int l, int r, Compare cmp )
+{
+
+  if ( r - l < SIMD_SORT_MAX && simdStableSort( source + l, r - l + 1, cmp ) )
+    std::move( source + l, source + r + 1, dest + l );
+  else if ( r - l < MERGE_INSERTION_CUTOFF )
+    {
+      insertionSort( source + l, r - l + 1, cmp );
+      std::move( source + l, source + r + 1, dest + l );
+    }
+  else
+    {
+      int mid = l + ( r - l )/2;
+      mergesort2Within( source, dest, l, mid, cmp );
+      mergesort2Within( source, dest, mid + 1, r, cmp );
+      merge2( source, dest, l, mid, r, cmp );
+    }
+
+}
+
+
+template <typename T, typename Compare>
+void mergesort2Within( T* arrayptr, T* scratch, int l, int r, Compare cmp )
 {
 
-  if ( l != r )
+  if ( r - l < SIMD_SORT_MAX && simdStableSort( arrayptr + l, r - l + 1, cmp ) )
+    return;
+  if ( r - l < MERGE_INSERTION_CUTOFF )
+    insertionSort( arrayptr + l, r - l + 1, cmp );
+  else
     {
-      int mid = ( l + r )/2;
-      mergesort2( dest, source, l, mid );
-      mergesort2( dest, source, mid + 1, r );
-      merge2( source, dest, l, mid, r );
+      int mid = l + ( r - l )/2;
+      mergesort2( arrayptr, scratch, l, mid, cmp );
+      mergesort2( arrayptr, scratch, mid + 1, r, cmp );
+      merge2( scratch, arrayptr, l, mid, r, cmp );
     }
 
 }
@@ -441,22 +540,24 @@ void mergesort2( T* source, T* dest, int l, int r )
 
 /******************************************************************************************
 *
-*   Function Name:
-*
-*   Purpose:
+*   Function Name:		merge2
 *
+*   Purpose:			merges the sorted ranges source[l..mid] and source[mid+1..r]
+*				into arrayptr[l..r], taking from the left range on ties so the
+*				merge is stable
 *
-*   Input Parameters:
+*   Input Parameters:		source - the sorted ranges, l, mid, r - their bounds,
+*				cmp - true if the first element comes before the second
 *
-*   Output parameters:
+*   Output parameters:		arrayptr - the merged range
 *
-*   Return Value:
+*   Return Value:		none
 *
 ******************************************************************************************/
 
 
-template <typename T>
-void merge2( T* source,  T* arrayptr , int l, int mid,  int r )
+template <typename T, typename Compare>
+void merge2( T* source,  T* arrayptr , int l, int mid,  int r, Compare cmp )
 {
 
   int i = l;
@@ -464,24 +565,1082 @@ void merge2( T* source,  T* arrayptr , int l, int mid,  int r )
   int k = l;
 
   while ( ( i <= mid  ) && ( j <= r ) )   	// Compare current item from each list
-    if ( source[ i ] < source[ j ]  )  		// Then i item comes first
-      arrayptr[ k++ ] = source[ i++ ];
-    else                                  	// j item comes first
-      arrayptr[ k++ ] = source[ j++ ];
+    if ( cmp( source[ j ], source[ i ] ) )  	// Then j item comes first
+      arrayptr[ k++ ] = std::move( source[ j++ ] );
+    else                                  	// i item comes first
+      arrayptr[ k++ ] = std::move( source[ i++ ] );
   						// Move what is left of remaining list
               
   if ( i > mid )
     while ( j <= r )
-      arrayptr[ k++ ] = source[ j++ ];
+      arrayptr[ k++ ] = std::move( source[ j++ ] );
   else
     while (i <= mid )
-      arrayptr[ k++ ] = source[ i++ ];
+      arrayptr[ k++ ] = std::move( source[ i++ ] );
       
      
 }
 
 
 
+/******************************************************************************************
+*
+*   Function Name:		bottomUpMergeSort
+*
+*   Purpose:			sorts an array by a stable bottom-up mergesort without
+*				recursion: insertion sorts runs of MERGE_BOTTOM_UP_RUN elements,
+*				then merges pairs of runs of doubling width back and forth
+*				between the array and one scratch array of arraySize elements.
+*				The caller may pass the scratch array in to sort many arrays
+*				without allocating; otherwise it is allocated once for the sort.
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				scratch - arraySize elements of scratch space,
+*				cmp - true if the first element comes before the second
+*				(operator< if not given)
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void bottomUpMergeSort( T* arrayptr, int arraySize, T* scratch, Compare cmp )
+{
+  T* source = arrayptr;
+  T* dest = scratch;
+  int width, l, run;
+
+  for ( l = 0; l < arraySize; l += MERGE_BOTTOM_UP_RUN )
+    {
+      run = ( arraySize - l < MERGE_BOTTOM_UP_RUN ) ? arraySize - l : MERGE_BOTTOM_UP_RUN;
+      if ( !simdStableSort( arrayptr + l, run, cmp ) )
+        insertionSort( arrayptr + l, run, cmp );
+    }
+
+  for ( width = MERGE_BOTTOM_UP_RUN; width < arraySize; width *= 2 )
+    {
+      // merge source[l..l+width-1] with source[l+width..l+2*width-1] into dest;
+      // a last run without a partner is moved over as it is
+      for ( l = 0; l < arraySize; l += 2 * width )
+        {
+          if ( arraySize - l <= width )
+            std::move( source + l, source + arraySize, dest + l );
+          else
+            merge2( source, dest, l, l + width - 1,
+                    ( arraySize - l - width <= width ) ? arraySize - 1 : l + 2 * width - 1, cmp );
+        }
+      std::swap( source, dest );
+    }
+
+  if ( source != arrayptr )
+    std::move( source, source + arraySize, arrayptr );
+}
+
+
+template <typename T, typename Compare>
+void bottomUpMergeSort( T* arrayptr, int arraySize, Compare cmp )
+{
+  std::vector<T> scratch( arraySize > MERGE_BOTTOM_UP_RUN ? arraySize : 0 );
+
+  bottomUpMergeSort( arrayptr, arraySize, scratch.data(), cmp );
+}
+
+
+template <typename T>
+void bottomUpMergeSort( T* arrayptr, int arraySize )
+{
+  bottomUpMergeSort( arrayptr, arraySize, std::less<T>() );
+}
+
+
+
+
+const int PDQ_INSERTION_CUTOFF = 24;          // ranges smaller than this are insertion sorted
+const int PDQ_NINTHER_THRESHOLD = 128;        // ranges larger than this take the median of 9 as pivot
+const int PDQ_PARTIAL_INSERTION_LIMIT = 8;    // # of moves before a partial insertion sort gives up
+const int PDQ_BLOCK_SIZE = 64;                // # of elements a partition block classifies at once
+
+
+/******************************************************************************************
+*
+*   Function Name:		heapSort
+*
+*   Purpose:			sorts an array with a binary max-heap in O(n log n) time in
+*				the worst case; pdqSort falls back on it when its pivots
+*				keep turning out bad
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void siftDown( T* arrayptr, int root, int arraySize,  Compare cmp )
+{
+  T target = std::move( arrayptr[ root ] );
+  int child;
+
+  // move the larger child up until target is not smaller than it
+  while ( ( child = 2 * root + 1 ) < arraySize )
+    {
+      if ( child + 1 < arraySize && cmp( arrayptr[ child ], arrayptr[ child + 1 ] ) )
+        child++;
+      if ( !cmp( target, arrayptr[ child ] ) )
+        break;
+      arrayptr[ root ] = std::move( arrayptr[ child ] );
+      root = child;
+    }
+  arrayptr[ root ] = std::move( target );
+}
+
+
+template <typename T, typename Compare>
+void heapSort( T* arrayptr, int arraySize,  Compare cmp )
+{
+  int i;
+
+  // build the heap from the last parent up to the root
+  for ( i = arraySize / 2 - 1; i >= 0; i-- )
+    siftDown( arrayptr, i, arraySize, cmp );
+
+  // move the largest element behind the heap and shrink it
+  for ( i = arraySize - 1; i > 0; i-- )
+    {
+      swap( arrayptr[ 0 ], arrayptr[ i ] );
+      siftDown( arrayptr, 0, i, cmp );
+    }
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		unguardedInsertionSort, partialInsertionSort
+*
+*   Purpose:			insertion sorts for pdqSort: unguardedInsertionSort sorts
+*				arrayptr[l..r-1] knowing that arrayptr[l-1] is not larger than
+*				any of them, so it never checks for the start of the array;
+*				partialInsertionSort gives up after moving more than
+*				PDQ_PARTIAL_INSERTION_LIMIT elements
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r) to sort,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the array with the range sorted, or partly sorted
+*
+*   Return Value:		partialInsertionSort: true if the range is sorted
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void unguardedInsertionSort( T* arrayptr, int l, int r,  Compare cmp )
+{
+  int i, j;
+
+  for ( i = l + 1; i < r; i++ )
+    if ( cmp( arrayptr[ i ], arrayptr[ i - 1 ] ) )
+      {
+        T target = std::move( arrayptr[ i ] );
+        j = i;
+        do
+          {
+            arrayptr[ j ] = std::move( arrayptr[ j - 1 ] );
+            j--;
+          }
+        while ( cmp( target, arrayptr[ j - 1 ] ) );
+        arrayptr[ j ] = std::move( target );
+      }
+}
+
+
+template <typename T, typename Compare>
+bool partialInsertionSort( T* arrayptr, int l, int r,  Compare cmp )
+{
+  int i, j;
+  int moves = 0;
+
+  for ( i = l + 1; i < r; i++ )
+    {
+      if ( cmp( arrayptr[ i ], arrayptr[ i - 1 ] ) )
+        {
+          T target = std::move( arrayptr[ i ] );
+          j = i;
+          do
+            {
+              arrayptr[ j ] = std::move( arrayptr[ j - 1 ] );
+              j--;
+            }
+          while ( j > l && cmp( target, arrayptr[ j - 1 ] ) );
+          arrayptr[ j ] = std::move( target );
+          moves += i - j;
+        }
+      if ( moves > PDQ_PARTIAL_INSERTION_LIMIT )
+        return false;
+    }
+  return true;
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		sort2, sort3
+*
+*   Purpose:			put two or three elements in order, to pick a pivot
+*
+*   Input Parameters:		a, b, c - the elements,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		a, b, c - the elements in order
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void sort2( T &a, T &b,  Compare cmp )
+{
+  if ( cmp( b, a ) )
+    swap( a, b );
+}
+
+
+template <typename T, typename Compare>
+void sort3( T &a, T &b, T &c,  Compare cmp )
+{
+  sort2( a, b, cmp );
+  sort2( b, c, cmp );
+  sort2( a, b, cmp );
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqPartitionRight
+*
+*   Purpose:			partitions arrayptr[l..r-1] around the pivot arrayptr[l]:
+*				elements smaller than the pivot go before it, the others
+*				after it. The elements are compared a block at a time and the
+*				positions of those on the wrong side are written into offset
+*				arrays without a branch, so the comparisons do not cause
+*				branch mispredictions (BlockQuicksort, Edelkamp and Weiss).
+*				An element not smaller than the pivot must exist in the
+*				range, which the median of 3 guarantees.
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r),
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the partitioned array, alreadyPartitioned - true
+*				if no element had to move
+*
+*   Return Value:		the position of the pivot
+*
+******************************************************************************************/
+
+
+template <typename T>
+void pdqSwapOffsets( T* leftBase, T* rightBase, unsigned char* offsetsL, unsigned char* offsetsR, int num,
+                     bool useSwaps )
+{
+  int i;
+
+  if ( useSwaps )
+    {
+      // pairwise swaps keep a descending input linear
+      for ( i = 0; i < num; i++ )
+        swap( leftBase[ offsetsL[ i ] ], rightBase[ -offsetsR[ i ] ] );
+    }
+  else if ( num > 0 )
+    {
+      // a cyclic permutation moves every element once instead of three times
+      T* left = leftBase + offsetsL[ 0 ];
+      T* right = rightBase - offsetsR[ 0 ];
+      T temp = std::move( *left );
+      *left = std::move( *right );
+      for ( i = 1; i < num; i++ )
+        {
+          left = leftBase + offsetsL[ i ];
+          *right = std::move( *left );
+          right = rightBase - offsetsR[ i ];
+          *left = std::move( *right );
+        }
+      *right = std::move( temp );
+    }
+}
+
+
+template <typename T, typename Compare>
+int pdqPartitionRight( T* arrayptr, int l, int r, bool &alreadyPartitioned,
+                       Compare cmp )
+{
+  T pivot = std::move( arrayptr[ l ] );
+  int first = l;
+  int last = r;
+  int i;
+
+  // find the first element not smaller than the pivot, and the last one smaller than it;
+  // the search for the latter needs a guard only if nothing was smaller than the pivot
+  while ( cmp( arrayptr[ ++first ], pivot ) )
+    ;
+  if ( first - 1 == l )
+    while ( first < last && !cmp( arrayptr[ --last ], pivot ) )
+      ;
+  else
+    while ( !cmp( arrayptr[ --last ], pivot ) )
+      ;
+
+  alreadyPartitioned = first >= last;
+  if ( !alreadyPartitioned )
+    {
+      swap( arrayptr[ first ], arrayptr[ last ] );
+      first++;
+
+      unsigned char offsetsL[ PDQ_BLOCK_SIZE ], offsetsR[ PDQ_BLOCK_SIZE ];
+      int leftBase = first, rightBase = last;
+      int numL = 0, numR = 0, startL = 0, startR = 0;
+
+      while ( first < last )
+        {
+          // split what is left between the offset blocks that are empty
+          int unknown = last - first;
+          int leftSplit = ( numL == 0 ) ? ( ( numR == 0 ) ? unknown / 2 : unknown ) : 0;
+          int rightSplit = ( numR == 0 ) ? unknown - leftSplit : 0;
+          if ( leftSplit > PDQ_BLOCK_SIZE )
+            leftSplit = PDQ_BLOCK_SIZE;
+          if ( rightSplit > PDQ_BLOCK_SIZE )
+            rightSplit = PDQ_BLOCK_SIZE;
+
+          // record the elements on the wrong side: always write the offset, but only
+          // count it if the element belongs on the other side
+          for ( i = 0; i < leftSplit; i++ )
+            {
+              offsetsL[ numL ] = static_cast<unsigned char>( i );
+              numL += !cmp( arrayptr[ first++ ], pivot );
+            }
+          for ( i = 0; i < rightSplit; i++ )
+            {
+              offsetsR[ numR ] = static_cast<unsigned char>( i + 1 );
+              numR += cmp( arrayptr[ --last ], pivot );
+            }
+
+          // swap as many pairs as both blocks have, and start over a block that is used up
+          int num = ( numL < numR ) ? numL : numR;
+          pdqSwapOffsets( arrayptr + leftBase, arrayptr + rightBase, offsetsL + startL, offsetsR + startR,
+                          num, numL == numR );
+          numL -= num;
+          numR -= num;
+          startL += num;
+          startR += num;
+          if ( numL == 0 )
+            {
+              startL = 0;
+              leftBase = first;
+            }
+          if ( numR == 0 )
+            {
+              startR = 0;
+              rightBase = last;
+            }
+        }
+
+      // one block may still hold elements on the wrong side: move them to the middle
+      if ( numL > 0 )
+        {
+          while ( numL-- > 0 )
+            swap( arrayptr[ leftBase + offsetsL[ startL + numL ] ], arrayptr[ --last ] );
+          first = last;
+        }
+      if ( numR > 0 )
+        {
+          while ( numR-- > 0 )
+            swap( arrayptr[ rightBase - offsetsR[ startR + numR ] ], arrayptr[ first++ ] );
+          last = first;
+        }
+    }
+
+  // put the pivot between the two sides
+  int pivotPos = first - 1;
+  arrayptr[ l ] = std::move( arrayptr[ pivotPos ] );
+  arrayptr[ pivotPos ] = std::move( pivot );
+  return pivotPos;
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqPartitionLeft
+*
+*   Purpose:			partitions arrayptr[l..r-1] around the pivot arrayptr[l]:
+*				elements equal to the pivot go before it with the smaller
+*				ones. pdqSort uses it when the pivot equals the element
+*				before the range, so every element equal to the pivot is put
+*				in place at once and many duplicates take linear time.
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r),
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the partitioned array
+*
+*   Return Value:		the position of the pivot
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+int pdqPartitionLeft( T* arrayptr, int l, int r,  Compare cmp )
+{
+  T pivot = std::move( arrayptr[ l ] );
+  int first = l;
+  int last = r;
+
+  while ( cmp( pivot, arrayptr[ --last ] ) )
+    ;
+  if ( last + 1 == r )
+    while ( first < last && !cmp( pivot, arrayptr[ ++first ] ) )
+      ;
+  else
+    while ( !cmp( pivot, arrayptr[ ++first ] ) )
+      ;
+
+  while ( first < last )
+    {
+      swap( arrayptr[ first ], arrayptr[ last ] );
+      while ( cmp( pivot, arrayptr[ --last ] ) )
+        ;
+      while ( !cmp( pivot, arrayptr[ ++first ] ) )
+        ;
+    }
+
+  arrayptr[ l ] = std::move( arrayptr[ last ] );
+  arrayptr[ last ] = std::move( pivot );
+  return last;
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqChoosePivot
+*
+*   Purpose:			moves the median of 3, or for ranges over
+*				PDQ_NINTHER_THRESHOLD the median of 3 medians of 3, to
+*				arrayptr[l] as the pivot; either way arrayptr[r-1] ends up
+*				not smaller than the pivot, which pdqPartitionRight needs
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r), at least
+*				PDQ_INSERTION_CUTOFF elements,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the range with the pivot first
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void pdqChoosePivot( T* arrayptr, int l, int r,  Compare cmp )
+{
+  int half = ( r - l ) / 2;
+
+  if ( r - l > PDQ_NINTHER_THRESHOLD )
+    {
+      sort3( arrayptr[ l ], arrayptr[ l + half ], arrayptr[ r - 1 ], cmp );
+      sort3( arrayptr[ l + 1 ], arrayptr[ l + half - 1 ], arrayptr[ r - 2 ], cmp );
+      sort3( arrayptr[ l + 2 ], arrayptr[ l + half + 1 ], arrayptr[ r - 3 ], cmp );
+      sort3( arrayptr[ l + half - 1 ], arrayptr[ l + half ], arrayptr[ l + half + 1 ], cmp );
+      swap( arrayptr[ l ], arrayptr[ l + half ] );
+    }
+  else
+    sort3( arrayptr[ l + half ], arrayptr[ l ], arrayptr[ r - 1 ], cmp );
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqBreakPatterns
+*
+*   Purpose:			after an unbalanced partition, swaps a few elements at the
+*				ends of both sides with elements a quarter of the way in, so
+*				the input pattern that made the pivot bad does not do so again
+*
+*   Input Parameters:		arrayptr - the array, l, r - the partitioned range [l, r),
+*				pivotPos - the position of the pivot
+*
+*   Output parameters:		arrayptr - the range with some elements swapped
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T>
+void pdqBreakPatterns( T* arrayptr, int l, int pivotPos, int r )
+{
+  int leftSize = pivotPos - l;
+  int rightSize = r - ( pivotPos + 1 );
+
+  if ( leftSize >= PDQ_INSERTION_CUTOFF )
+    {
+      swap( arrayptr[ l ], arrayptr[ l + leftSize / 4 ] );
+      swap( arrayptr[ pivotPos - 1 ], arrayptr[ pivotPos - leftSize / 4 ] );
+      if ( leftSize > PDQ_NINTHER_THRESHOLD )
+        {
+          swap( arrayptr[ l + 1 ], arrayptr[ l + leftSize / 4 + 1 ] );
+          swap( arrayptr[ l + 2 ], arrayptr[ l + leftSize / 4 + 2 ] );
+          swap( arrayptr[ pivotPos - 2 ], arrayptr[ pivotPos - leftSize / 4 - 1 ] );
+          swap( arrayptr[ pivotPos - 3 ], arrayptr[ pivotPos - leftSize / 4 - 2 ] );
+        }
+    }
+  if ( rightSize >= PDQ_INSERTION_CUTOFF )
+    {
+      swap( arrayptr[ pivotPos + 1 ], arrayptr[ pivotPos + 1 + rightSize / 4 ] );
+      swap( arrayptr[ r - 1 ], arrayptr[ r - rightSize / 4 ] );
+      if ( rightSize > PDQ_NINTHER_THRESHOLD )
+        {
+          swap( arrayptr[ pivotPos + 2 ], arrayptr[ pivotPos + 2 + rightSize / 4 ] );
+          swap( arrayptr[ pivotPos + 3 ], arrayptr[ pivotPos + 3 + rightSize / 4 ] );
+          swap( arrayptr[ r - 2 ], arrayptr[ r - 1 - rightSize / 4 ] );
+          swap( arrayptr[ r - 3 ], arrayptr[ r - 2 - rightSize / 4 ] );
+        }
+    }
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqSortLoop
+*
+*   Purpose:			sorts arrayptr[l..r-1] by pattern-defeating quicksort: sorts
+*				the smaller side of every partition by recursion and the other
+*				one in the loop. Ranges below PDQ_INSERTION_CUTOFF are
+*				insertion sorted. A partition that moved nothing ends in a
+*				partial insertion sort, which finishes sorted ranges in linear
+*				time; an unbalanced one shuffles a few elements to break the
+*				pattern, and after badAllowed of them the range is heap
+*				sorted, so the sort never takes more than O(n log n).
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r),
+*				badAllowed - # of unbalanced partitions before heapSort,
+*				leftmost - true if no element precedes the range,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the array with the range sorted
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void pdqSortLoop( T* arrayptr, int l, int r, int badAllowed, bool leftmost,
+                  Compare cmp )
+{
+  while ( true )
+    {
+      int size = r - l;
+      if ( size <= SIMD_SORT_MAX && simdSort( arrayptr + l, size, cmp ) )
+        return;
+      if ( size < PDQ_INSERTION_CUTOFF )
+        {
+          if ( leftmost )
+            insertionSort( arrayptr + l, size, cmp );
+          else
+            unguardedInsertionSort( arrayptr, l, r, cmp );
+          return;
+        }
+
+      pdqChoosePivot( arrayptr, l, r, cmp );
+
+      // a pivot equal to the element before the range is the smallest in it:
+      // put every element equal to it in place and go on with the larger ones
+      if ( !leftmost && !cmp( arrayptr[ l - 1 ], arrayptr[ l ] ) )
+        {
+          l = pdqPartitionLeft( arrayptr, l, r, cmp ) + 1;
+          continue;
+        }
+
+      bool alreadyPartitioned;
+      int pivotPos = pdqPartitionRight( arrayptr, l, r, alreadyPartitioned, cmp );
+      int leftSize = pivotPos - l;
+      int rightSize = r - ( pivotPos + 1 );
+
+      if ( leftSize < size / 8 || rightSize < size / 8 )
+        {
+          // an unbalanced partition: give up on quicksort after too many of them,
+          // otherwise swap a few elements to break the pattern that caused it
+          if ( --badAllowed == 0 )
+            {
+              heapSort( arrayptr + l, size, cmp );
+              return;
+            }
+          pdqBreakPatterns( arrayptr, l, pivotPos, r );
+        }
+      else if ( alreadyPartitioned
+                && partialInsertionSort( arrayptr, l, pivotPos, cmp )
+                && partialInsertionSort( arrayptr, pivotPos + 1, r, cmp ) )
+        return;      // the range was sorted, or nearly
+
+      // recurse into the smaller side, loop on the larger one
+      if ( leftSize < rightSize )
+        {
+          pdqSortLoop( arrayptr, l, pivotPos, badAllowed, leftmost, cmp );
+          l = pivotPos + 1;
+          leftmost = false;
+        }
+      else
+        {
+          pdqSortLoop( arrayptr, pivotPos + 1, r, badAllowed, false, cmp );
+          r = pivotPos;
+        }
+    }
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		pdqSort
+*
+*   Purpose:			sorts an array by pattern-defeating quicksort (Orson Peters):
+*				an unstable O(n log n) sort that takes linear time on sorted,
+*				reversed and few-unique inputs and falls back on heapSort
+*				rather than go quadratic
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void pdqSort( T* arrayptr, int arraySize,  Compare cmp )
+{
+  int log2Size = 0;
+
+  if ( arraySize < 2 )
+    return;
+  while ( ( arraySize >> log2Size ) > 1 )
+    log2Size++;
+  pdqSortLoop( arrayptr, 0, arraySize, log2Size, true, cmp );
+}
+
+
+const int PARALLEL_SORT_GRAIN = 1 << 14;      // ranges up to this size are sorted by one task
+const int PARALLEL_MERGE_GRAIN = 1 << 14;     // # of elements one task of a parallel merge merges at least
+
+
+/******************************************************************************************
+*
+*   Function Name:		coRank
+*
+*   Purpose:			finds how a stable merge of the sorted ranges source[l..mid]
+*				and source[mid+1..r] splits its first k outputs: they are the
+*				first i - l elements of the left range and the first
+*				k - (i - l) of the right one. A binary search for the largest i
+*				whose left element before it is not after the right element
+*				it would precede.
+*
+*   Input Parameters:		source - the sorted ranges, l, mid, r - their bounds,
+*				k - # of outputs, cmp - true if the first element comes
+*				before the second
+*
+*   Output parameters:		none
+*
+*   Return Value:		i, the end of the left range in the first k outputs
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+int coRank( T* source, int l, int mid, int r, int k,  Compare cmp )
+{
+  int leftSize = mid - l + 1;
+  int rightSize = r - mid;
+  int low = ( k > rightSize ) ? k - rightSize : 0;
+  int high = ( k < leftSize ) ? k : leftSize;
+
+  while ( low < high )
+    {
+      // take i left elements: too many if the last of them comes after
+      // the first right element that would not be taken
+      int i = low + ( high - low + 1 ) / 2;
+      if ( cmp( source[ mid + 1 + k - i ], source[ l + i - 1 ] ) )
+        high = i - 1;
+      else
+        low = i;
+    }
+  return l + low;
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		parallelMerge
+*
+*   Purpose:			does what merge2 does on the threads of a pool: cuts the
+*				output into equal parts, finds by coRank where every part
+*				starts in both ranges, and merges every part as a task. The
+*				cuts are all found before any part is merged, since the
+*				merges move the elements out of the ranges.
+*
+*   Input Parameters:		source - the sorted ranges, l, mid, r - their bounds,
+*				cmp - true if the first element comes before the second,
+*				pool - the threads
+*
+*   Output parameters:		dest - the merged range
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void parallelMerge( T* source, T* dest, int l, int mid, int r,  Compare cmp, TaskPool &pool )
+{
+  int total = r - l + 1;
+  int parts = total / PARALLEL_MERGE_GRAIN;
+  int maxParts = static_cast<int>( pool.threadCount() ) * 4;
+  int p;
+
+  if ( parts > maxParts )
+    parts = maxParts;
+  if ( parts < 2 )
+    {
+      merge2( source, dest, l, mid, r, cmp );
+      return;
+    }
+
+  std::vector<int> firsts( parts + 1 );
+  std::vector<int> cuts( parts + 1 );
+  for ( p = 0; p <= parts; p++ )
+    {
+      firsts[ p ] = static_cast<int>( static_cast<long long>( total ) * p / parts );
+      cuts[ p ] = coRank( source, l, mid, r, firsts[ p ], cmp );
+    }
+
+  TaskGroup group( pool );
+  for ( p = 0; p < parts; p++ )
+    {
+      int first = firsts[ p ];
+      int last = firsts[ p + 1 ];
+      int i = cuts[ p ];
+      int iEnd = cuts[ p + 1 ];
+      group.run( [=]()
+        {
+          int j = mid + 1 + first - ( i - l );
+          int jEnd = mid + 1 + last - ( iEnd - l );
+          std::merge( std::make_move_iterator( source + i ), std::make_move_iterator( source + iEnd ),
+                      std::make_move_iterator( source + j ), std::make_move_iterator( source + jEnd ),
+                      dest + l + first, cmp );
+        } );
+    }
+  group.wait();
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		parallelMergesort2, parallelMergesort2Within
+*
+*   Purpose:			do what mergesort2 and mergesort2Within do on the threads of
+*				a pool: above PARALLEL_SORT_GRAIN elements the left half is
+*				sorted as a task while the calling thread sorts the right
+*				half, and the halves are merged by parallelMerge
+*
+*   Input Parameters:		source, arrayptr - the elements to sort, dest, scratch - the
+*				other array, l, r - the range to sort,
+*				cmp - true if the first element comes before the second,
+*				pool - the threads
+*
+*   Output parameters:		dest, arrayptr - the sorted range
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void parallelMergesort2Within( T* arrayptr, T* scratch, int l, int r,  Compare cmp, TaskPool &pool );
+
+
+template <typename T, typename Compare>
+void parallelMergesort2( T* source, T* dest, int l, int r,  Compare cmp, TaskPool &pool )
+{
+  if ( r - l < PARALLEL_SORT_GRAIN )
+    {
+      mergesort2( source, dest, l, r, cmp );
+      return;
+    }
+
+  int mid = l + ( r - l ) / 2;
+  TaskGroup group( pool );
+  group.run( [=, &pool]() { parallelMergesort2Within( source, dest, l, mid, cmp, pool ); } );
+  parallelMergesort2Within( source, dest, mid + 1, r, cmp, pool );
+  group.wait();
+  parallelMerge( source, dest, l, mid, r, cmp, pool );
+}
+
+
+template <typename T, typename Compare>
+void parallelMergesort2Within( T* arrayptr, T* scratch, int l, int r,  Compare cmp, TaskPool &pool )
+{
+  if ( r - l < PARALLEL_SORT_GRAIN )
+    {
+      mergesort2Within( arrayptr, scratch, l, r, cmp );
+      return;
+    }
+
+  int mid = l + ( r - l ) / 2;
+  TaskGroup group( pool );
+  group.run( [=, &pool]() { parallelMergesort2( arrayptr, scratch, l, mid, cmp, pool ); } );
+  parallelMergesort2( arrayptr, scratch, mid + 1, r, cmp, pool );
+  group.wait();
+  parallelMerge( scratch, arrayptr, l, mid, r, cmp, pool );
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		parallelMsSort
+*
+*   Purpose:			sorts an array like msSort, stable, on threadNum threads that
+*				split the recursion and the merges between them by work
+*				stealing
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				scratch - arraySize elements of scratch space,
+*				cmp - true if the first element comes before the second,
+*				threadNum - # of threads, counting the caller, 0 for one per
+*				core
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void parallelMsSort( T* arrayptr, int arraySize, T* scratch,  Compare cmp, int threadNum )
+{
+  if ( arraySize <= PARALLEL_SORT_GRAIN || threadNum == 1 )
+    {
+      msSort( arrayptr, arraySize, scratch, cmp );
+      return;
+    }
+
+  TaskPool pool( threadNum );
+  parallelMergesort2Within( arrayptr, scratch, 0, arraySize - 1, cmp, pool );
+}
+
+
+template <typename T, typename Compare>
+void parallelMsSort( T* arrayptr, int arraySize,  Compare cmp, int threadNum = 0 )
+{
+  std::vector<T> scratch( arraySize > 1 ? arraySize : 0 );
+
+  parallelMsSort( arrayptr, arraySize, scratch.data(), cmp, threadNum );
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		parallelPdqSortLoop
+*
+*   Purpose:			does what pdqSortLoop does, but above PARALLEL_SORT_GRAIN
+*				elements it gives the left side of every partition to the
+*				pool as a task and goes on with the right side, so the sides
+*				are sorted on all threads at once
+*
+*   Input Parameters:		arrayptr - the array, l, r - the range [l, r),
+*				badAllowed - # of unbalanced partitions before heapSort,
+*				leftmost - true if no element precedes the range,
+*				cmp - true if the first element comes before the second,
+*				pool - the threads, group - the group of the tasks of the sort
+*
+*   Output parameters:		arrayptr - the array with the range sorted, once the tasks of
+*				group are done
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void parallelPdqSortLoop( T* arrayptr, int l, int r, int badAllowed, bool leftmost,
+                          Compare cmp, TaskPool &pool, TaskGroup &group )
+{
+  while ( r - l > PARALLEL_SORT_GRAIN )
+    {
+      int size = r - l;
+      pdqChoosePivot( arrayptr, l, r, cmp );
+
+      if ( !leftmost && !cmp( arrayptr[ l - 1 ], arrayptr[ l ] ) )
+        {
+          l = pdqPartitionLeft( arrayptr, l, r, cmp ) + 1;
+          continue;
+        }
+
+      bool alreadyPartitioned;
+      int pivotPos = pdqPartitionRight( arrayptr, l, r, alreadyPartitioned, cmp );
+      int leftSize = pivotPos - l;
+      int rightSize = r - ( pivotPos + 1 );
+
+      if ( leftSize < size / 8 || rightSize < size / 8 )
+        {
+          if ( --badAllowed == 0 )
+            {
+              heapSort( arrayptr + l, size, cmp );
+              return;
+            }
+          pdqBreakPatterns( arrayptr, l, pivotPos, r );
+        }
+      else if ( alreadyPartitioned
+                && partialInsertionSort( arrayptr, l, pivotPos, cmp )
+                && partialInsertionSort( arrayptr, pivotPos + 1, r, cmp ) )
+        return;
+
+      // no task touches the pivot again, so the two sides can be sorted at once
+      group.run( [=, &pool, &group]()
+        {
+          parallelPdqSortLoop( arrayptr, l, pivotPos, badAllowed, leftmost, cmp, pool, group );
+        } );
+      l = pivotPos + 1;
+      leftmost = false;
+    }
+  pdqSortLoop( arrayptr, l, r, badAllowed, leftmost, cmp );
+}
+
+
+/******************************************************************************************
+*
+*   Function Name:		parallelPdqSort
+*
+*   Purpose:			sorts an array like pdqSort, not stable, on threadNum threads
+*				that share the sides of the partitions by work stealing. The
+*				first partitions are done by one thread, so the speedup is
+*				less than that of parallelMsSort, but no scratch space is used.
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				cmp - true if the first element comes before the second,
+*				threadNum - # of threads, counting the caller, 0 for one per
+*				core
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T, typename Compare>
+void parallelPdqSort( T* arrayptr, int arraySize,  Compare cmp, int threadNum = 0 )
+{
+  int log2Size = 0;
+
+  if ( arraySize <= PARALLEL_SORT_GRAIN || threadNum == 1 )
+    {
+      pdqSort( arrayptr, arraySize, cmp );
+      return;
+    }
+  while ( ( arraySize >> log2Size ) > 1 )
+    log2Size++;
+
+  TaskPool pool( threadNum );
+  TaskGroup group( pool );
+  group.run( [=, &pool, &group]()
+    {
+      parallelPdqSortLoop( arrayptr, 0, arraySize, log2Size, true, cmp, pool, group );
+    } );
+  group.wait();
+}
+
+
+
+
+/******************************************************************************************
+*
+*   Function Name:		selectSort, doubleSeletcSort, insertionSort, bubbleSort,
+*				basicBubbleSort, heapSort, pdqSort
+*
+*   Purpose:			the versions of the sorts that take the comparator as a
+*				function pointer, as they all did before the comparator became
+*				a template parameter. Each one sorts by the template version,
+*				which calls the comparator through the pointer; a functor, a
+*				lambda or std::less passed to the template version instead is
+*				inlined into the comparisons.
+*
+*   Input Parameters:		arrayptr - the array, arraySize - # of elements in it,
+*				cmp - true if the first element comes before the second
+*
+*   Output parameters:		arrayptr - the sorted array
+*
+*   Return Value:		none
+*
+******************************************************************************************/
+
+
+template <typename T>
+void selectSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  selectSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void doubleSeletcSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  doubleSeletcSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void insertionSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  insertionSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void bubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  bubbleSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void basicBubbleSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  basicBubbleSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void heapSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  heapSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+template <typename T>
+void pdqSort( T* arrayptr, int arraySize,  bool ( *cmp )( T &baseData1, T &baseData2 ) )
+{
+  pdqSort<T, bool ( * )( T &, T & )>( arrayptr, arraySize, cmp );
+}
+
+
+
 
 
 #endif
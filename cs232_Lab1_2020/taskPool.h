@@ -0,0 +1,364 @@
+/**********************************************************************
+ * File name: taskPool.h
+ * -----------------------
+ * This file defines the TaskPool class, a fixed set of threads that
+ * run small tasks by work stealing, for the parallel in-memory sorts.
+ *
+ * Every thread has its own deque of tasks. A thread pushes the tasks
+ * it creates at the back of its deque and takes its next task from
+ * the back too, so it goes on with the newest, smallest piece of its
+ * own work while that is still in its cache; an idle thread steals
+ * from the front of another deque, which holds the oldest and largest
+ * pieces. A thread that waits for a group of tasks runs tasks until
+ * the group is done, so a task may split itself and wait for its
+ * parts without tying up a thread. A group waits for its tasks when
+ * it is destroyed as well, so a task that throws before it waits for
+ * its parts does not leave them running on a group that is gone.
+ *
+ * Unlike the other headers of the sorter this one does not use the
+ * std namespace, since sort_algorithms.t, which includes it, defines
+ * its own swap template.
+ *
+ * This file defines the
+ *      TaskPool class:   the threads and their deques of tasks.
+ *      TaskGroup class:  a set of tasks of a pool that can be waited for.
+ *
+ * Programmer: Jian Zhong
+ * Date Written: 10/17/2026
+ * Date Last Revised: 10/17/2026
+ **********************************************************************/
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+#include <cstddef>             // size_t
+#include <deque>               // std::deque<Task> tasks
+#include <vector>              // std::vector<std::thread> threads
+#include <memory>              // std::unique_ptr<TaskDeque>
+#include <functional>          // std::function<void()> work
+#include <thread>              // std::thread, hardware_concurrency, yield
+#include <mutex>               // std::mutex, lock_guard, unique_lock
+#include <condition_variable>  // std::condition_variable wake
+#include <atomic>              // std::atomic counters
+#include <exception>           // std::exception_ptr
+
+
+class TaskPool;
+
+
+/*
+ * Type: TaskGroup
+ * ---------------
+ * The tasks given to a pool together, and the first exception any of
+ * them threw.
+ */
+class TaskGroup
+{
+private:
+    TaskPool& pool;                  // the pool that runs the tasks
+    std::atomic<size_t> pending;     // # of tasks not yet done
+    std::mutex lock;                 // guards error
+    std::exception_ptr error;        // the first exception a task threw
+
+    friend class TaskPool;
+
+public:
+    /* Constructor */
+    explicit TaskGroup(TaskPool& pool) : pool(pool), pending(0) {}
+
+    /* Destructor: wait for the tasks, dropping their exceptions */
+    ~TaskGroup();
+
+    /* Give a task to the pool as part of the group */
+    void run(std::function<void()> task);
+
+    /* Run tasks until every task of the group is done; rethrow the first exception of the group */
+    void wait();
+};
+
+
+/*
+ * Type: TaskPool
+ * --------------
+ * threadNum - 1 threads of its own and the thread that waits for a
+ * group, which runs tasks as well, each with a deque of tasks.
+ */
+class TaskPool
+{
+private:
+    struct Task
+    {
+        std::function<void()> work;          // what to do
+        TaskGroup* group;                    // the group the task is part of
+    };
+
+    struct TaskDeque
+    {
+        std::mutex lock;                     // guards tasks
+        std::deque<Task> tasks;              // the owner works at the back, thieves at the front
+    };
+
+    std::vector<std::unique_ptr<TaskDeque> > deques;   // one per thread; 0 for threads not of the pool
+    std::vector<std::thread> threads;                  // the threads of the pool
+    std::atomic<size_t> queued;                        // # of tasks in all deques
+    bool stopping;                                     // whether the threads are to end
+    std::mutex sleepLock;                              // guards stopping, and waits for tasks
+    std::condition_variable wake;                      // signaled when a task is queued or the pool stops
+
+    /* Return the index of the deque of the calling thread */
+    size_t self() const;
+
+    /* Run one task of the calling thread, or one stolen from another thread; false if none */
+    bool runOne(size_t index);
+
+    /* Run tasks until the pool stops */
+    void work(size_t index);
+
+    /* Give a task to the pool as part of a group */
+    void run(TaskGroup& group, std::function<void()> task);
+
+    /* Run tasks until every task of a group is done */
+    void help(TaskGroup& group);
+
+    friend class TaskGroup;
+
+public:
+    /* Constructor: threadNum threads in all, counting the caller; 0 for one per core */
+    explicit TaskPool(size_t threadNum = 0);
+
+    /* Destructor: end the threads of the pool */
+    ~TaskPool();
+
+    /* Return the # of threads that run tasks, counting the caller */
+    size_t threadCount() const { return deques.size(); }
+
+}; /* end of TaskPool class */
+
+
+/*******************************************************************************************
+ * Constructor: TaskPool
+ * ------------------
+ * Purpose: To start threadNum - 1 threads, each with an empty deque, and a deque for the
+ *          threads that are not of the pool.
+ *
+ * Input Parameters:
+ *          threadNum: # of threads that run tasks, counting the caller, 0 for one per core.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline TaskPool::TaskPool(size_t threadNum) : queued(0), stopping(false)
+{
+    if (threadNum == 0)
+        threadNum = std::thread::hardware_concurrency();
+    if (threadNum == 0)
+        threadNum = 1;
+    for (size_t i = 0; i < threadNum; i++)
+        deques.push_back(std::unique_ptr<TaskDeque>(new TaskDeque()));
+    for (size_t i = 1; i < threadNum; i++)
+        threads.push_back(std::thread([this, i]() { work(i); }));
+}
+
+
+/*******************************************************************************************
+ * Destructor: TaskPool
+ * ------------------
+ * Purpose: To end the threads of the pool once they are done with the task they are on.
+ *******************************************************************************************/
+inline TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+}
+
+
+/*******************************************************************************************
+ * Function Name: self
+ * ------------------
+ * Purpose: To find the deque of the calling thread: its own for a thread of this pool,
+ *          deque 0 for any other thread.
+ *
+ * Input Parameters: none.
+ * Output parameters: none.
+ * Return Value:
+ *          size_t: the index of the deque.
+ *******************************************************************************************/
+inline size_t TaskPool::self() const
+{
+    for (size_t i = 0; i < threads.size(); i++)
+        if (threads[i].get_id() == std::this_thread::get_id())
+            return i + 1;
+    return 0;
+}
+
+
+/*******************************************************************************************
+ * Function Name: run
+ * ------------------
+ * Purpose: To push a task at the back of the deque of the calling thread and wake a thread
+ *          that waits for work.
+ *
+ * Input Parameters:
+ *          group: the group the task is part of.
+ *          task: the task.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void TaskPool::run(TaskGroup& group, std::function<void()> task)
+{
+    TaskDeque& own = *deques[self()];
+    group.pending++;
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.tasks.push_back(Task{ std::move(task), &group });
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);     // a thread about to sleep sees the task
+        queued++;
+    }
+    wake.notify_one();
+}
+
+
+/*******************************************************************************************
+ * Function Name: runOne
+ * ------------------
+ * Purpose: To run the newest task of a deque or, if it is empty, the oldest task of another
+ *          one, trying the deques after it in turn. An exception of the task is kept in its
+ *          group.
+ *
+ * Input Parameters:
+ *          index: the deque of the calling thread.
+ * Output parameters: none.
+ * Return Value:
+ *          bool: false if every deque was empty.
+ *******************************************************************************************/
+inline bool TaskPool::runOne(size_t index)
+{
+    Task task;
+    bool found = false;
+    for (size_t i = 0; i < deques.size() && !found; i++)
+    {
+        TaskDeque& victim = *deques[(index + i) % deques.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.tasks.empty())
+            continue;
+        if (i == 0)
+        {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+        found = true;
+    }
+    if (!found)
+        return false;
+
+    queued--;
+    try {
+        task.work();
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> guard(task.group->lock);
+        if (!task.group->error)
+            task.group->error = std::current_exception();
+    }
+    task.group->pending--;
+    return true;
+}
+
+
+/*******************************************************************************************
+ * Function Name: work
+ * ------------------
+ * Purpose: To run tasks on a thread of the pool, sleeping while there are none, until the
+ *          pool stops.
+ *
+ * Input Parameters:
+ *          index: the deque of the thread.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void TaskPool::work(size_t index)
+{
+    while (true)
+    {
+        if (runOne(index))
+            continue;
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping || queued > 0; });
+        if (stopping)
+            return;
+    }
+}
+
+
+/*******************************************************************************************
+ * Function Name: help
+ * ------------------
+ * Purpose: To run tasks on the calling thread until every task of a group is done.
+ *
+ * Input Parameters:
+ *          group: the group.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void TaskPool::help(TaskGroup& group)
+{
+    size_t index = self();
+    while (group.pending > 0)
+        if (!runOne(index))
+            std::this_thread::yield();      // the last tasks of the group run on other threads
+}
+
+
+/*******************************************************************************************
+ * Function Name: run / wait
+ * ------------------
+ * Purpose: To give a task to the pool as part of the group, and to run tasks until every
+ *          task of the group is done, then rethrow the first exception one of them threw.
+ *
+ * Input Parameters:
+ *          task: the task.
+ * Output parameters: none.
+ * Return Value: none.
+ *******************************************************************************************/
+inline void TaskGroup::run(std::function<void()> task)
+{
+    pool.run(*this, std::move(task));
+}
+
+inline void TaskGroup::wait()
+{
+    pool.help(*this);
+
+    std::exception_ptr thrown;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        std::swap(thrown, error);
+    }
+    if (thrown)
+        std::rethrow_exception(thrown);
+}
+
+
+/*******************************************************************************************
+ * Destructor: TaskGroup
+ * ------------------
+ * Purpose: To wait for the tasks of the group, which may still be running if the thread
+ *          that gave them to the pool threw before it waited for them.
+ *******************************************************************************************/
+inline TaskGroup::~TaskGroup()
+{
+    pool.help(*this);
+}
+
+#endif //TASKPOOL_H